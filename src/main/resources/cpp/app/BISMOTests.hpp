@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <iostream>
 #include <vector>
+#include <thread>
 using namespace std;
 #include "gemmbitserial/test/testhelpers.hpp"
 #include "gemmbitserial/gemmbitserial.hpp"
@@ -46,7 +47,8 @@ using namespace std;
 bool test(
   string testName,
   size_t nrows_lhs, size_t nrows_rhs, size_t ncols, size_t nbits_lhs = 1,
-  size_t nbits_rhs = 1, bool sgn_lhs = false, bool sgn_rhs = false
+  size_t nbits_rhs = 1, bool sgn_lhs = false, bool sgn_rhs = false,
+  bismo_rt::InstrGenSource instrgen = bismo_rt::instrGenHW
 ) {
   uint8_t * lhs = new uint8_t[nrows_lhs * ncols];
   uint8_t * rhs = new uint8_t[nrows_rhs * ncols];
@@ -72,6 +74,7 @@ bool test(
   dscr.K = ncols;
   dscr.N = nrows_rhs;
   bismo_rt::init();
+  bismo_rt::setInstrGenSource(instrgen);
   bismo_rt::LayerHandle id = bismo_rt::initMatMul(dscr);
   uint8_t * accel_lhs = bismo_rt::getLayerLHSBuffer(id);
   uint8_t * accel_rhs = bismo_rt::getLayerRHSBuffer(id);
@@ -228,3 +231,297 @@ bool test_binary_offchip_widerows_multitile(bismo_rt::HardwareConfig hwcfg) {
   }
   return all_OK;
 }
+
+// K is too large for a single stripe to fit into on-chip memory, so the
+// runtime splits it into several chunks and sums up the partial results.
+// a single binary result tile is accumulated across the chunks on chip.
+bool test_ktiling(bismo_rt::HardwareConfig hwcfg) {
+  bool all_OK = true;
+  const size_t k_ocm = hwcfg.dpaDimCommon*hwcfg.lhsEntriesPerMem;
+  all_OK &= test("ktiling_1b_x_1b", 2*hwcfg.dpaDimLHS, 2*hwcfg.dpaDimRHS, 2*k_ocm);
+  all_OK &= test("ktiling_2b_x_3b_signed", hwcfg.dpaDimLHS, 3*hwcfg.dpaDimRHS, k_ocm + 100, 2, 3, true, true);
+  all_OK &= test("ktiling_unaligned", 17, 7, 3*k_ocm + 5, 1, 2);
+  all_OK &= test("ktiling_accumulate", hwcfg.dpaDimLHS, hwcfg.dpaDimRHS, 3*k_ocm + 5);
+  all_OK &= test("ktiling_accumulate_signed_host", hwcfg.dpaDimLHS, hwcfg.dpaDimRHS, 2*k_ocm, 1, 1, true, false, bismo_rt::instrGenHost);
+  return all_OK;
+}
+
+// M and N are too large for the 16-bit tile counts and result row stride
+// of a single descriptor, so the runtime splits them into several
+// descriptors that each cover a block of the result.
+bool test_mntiling(bismo_rt::HardwareConfig hwcfg) {
+  bool all_OK = true;
+  all_OK &= test("mntiling_tall", 16384 + 5, hwcfg.dpaDimRHS, hwcfg.dpaDimCommon, 1, 2);
+  all_OK &= test("mntiling_many_tiles", 512*hwcfg.dpaDimLHS, 128*hwcfg.dpaDimRHS, hwcfg.dpaDimCommon);
+  all_OK &= test("mntiling_many_tiles_host", 512*hwcfg.dpaDimLHS + 3, 128*hwcfg.dpaDimRHS + 1, hwcfg.dpaDimCommon, 2, 1, false, false, bismo_rt::instrGenHost);
+  return all_OK;
+}
+
+// check which loop order the runtime chooses for a layer of given shape,
+// without running it
+bool test_tiling_choice(
+  string testName,
+  size_t nrows_lhs, size_t nrows_rhs, size_t ncols, size_t nbits_lhs,
+  size_t nbits_rhs, bool lhs_stationary, bool lhs_resident
+) {
+  cout << "Starting test: " << testName << endl;
+  bismo_rt::MatMulDescriptor dscr;
+  dscr.wbits = nbits_lhs;
+  dscr.ibits = nbits_rhs;
+  dscr.wsigned = false;
+  dscr.isigned = false;
+  dscr.M = nrows_lhs;
+  dscr.K = ncols;
+  dscr.N = nrows_rhs;
+  bismo_rt::init();
+  bismo_rt::LayerHandle id = bismo_rt::initMatMul(dscr);
+  bismo_rt::InstrumentationData data = bismo_rt::getInstrumentationData(id);
+  bool all_OK = true;
+  all_OK &= (data["tiling_lhs_stationary"] == (lhs_stationary ? 1 : 0));
+  all_OK &= (data["tiling_lhs_resident"] == (lhs_resident ? 1 : 0));
+  bismo_rt::deinitMatMul(id);
+  bismo_rt::deinit();
+  cout << "Test " << (all_OK ? "succeeded" : "failed") << " (" << testName << ")" << endl;
+  return all_OK;
+}
+
+// tall, wide and small square matrices, so that the RHS-stationary and the
+// LHS-stationary loop order and the resident LHS are all chosen
+bool test_tiling_order(bismo_rt::HardwareConfig hwcfg) {
+  bool all_OK = true;
+  all_OK &= test_tiling_choice("tiling_lhs_resident_choice", 4*hwcfg.dpaDimLHS, 4*hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 1, 2, false, true);
+  all_OK &= test_tiling_choice("tiling_rhs_stationary_choice", 8*hwcfg.dpaDimLHS, hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 2, 2, false, false);
+  all_OK &= test_tiling_choice("tiling_lhs_stationary_choice", hwcfg.dpaDimLHS, 8*hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 2, 2, true, false);
+  all_OK &= test("tiling_lhs_resident", 4*hwcfg.dpaDimLHS, 4*hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 1, 2, true, false);
+  all_OK &= test("tiling_lhs_resident_host", 4*hwcfg.dpaDimLHS, 4*hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 2, 2, false, true, bismo_rt::instrGenHost);
+  all_OK &= test("tiling_rhs_stationary", 8*hwcfg.dpaDimLHS, hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 2, 2);
+  all_OK &= test("tiling_lhs_stationary", hwcfg.dpaDimLHS, 8*hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 2, 2, true, true);
+  all_OK &= test("tiling_lhs_stationary_host", hwcfg.dpaDimLHS, 8*hwcfg.dpaDimRHS, 2*hwcfg.dpaDimCommon, 3, 1, false, false, bismo_rt::instrGenHost);
+  return all_OK;
+}
+
+// same as the multitile and K tiling tests, but with the instructions
+// generated on the host and fed to the accelerator directly
+bool test_host_instrgen(bismo_rt::HardwareConfig hwcfg) {
+  bool all_OK = true;
+  const bismo_rt::InstrGenSource src = bismo_rt::instrGenHost;
+  const size_t k_ocm = hwcfg.dpaDimCommon*hwcfg.lhsEntriesPerMem;
+  all_OK &= test("host_instrgen_onetile", hwcfg.dpaDimLHS, hwcfg.dpaDimRHS, hwcfg.dpaDimCommon, 1, 1, false, false, src);
+  all_OK &= test("host_instrgen_multitile", 3*hwcfg.dpaDimLHS, 2*hwcfg.dpaDimRHS, 4*hwcfg.dpaDimCommon, 2, 3, true, false, src);
+  all_OK &= test("host_instrgen_ktiling", 17, 7, 2*k_ocm + 5, 1, 2, false, true, src);
+  return all_OK;
+}
+
+// constant LHS: changes to the host buffer after the first sync must be
+// ignored, while the RHS is updated for every run as usual
+bool test_const_lhs(bismo_rt::HardwareConfig hwcfg) {
+  string testName = "const_lhs";
+  cout << "Starting test: " << testName << endl;
+  const size_t nrows_lhs = 2*hwcfg.dpaDimLHS, nrows_rhs = hwcfg.dpaDimRHS;
+  const size_t ncols = 256, nbits_lhs = 2, nbits_rhs = 2, nruns = 3;
+  bismo_rt::MatMulDescriptor dscr;
+  dscr.wbits = nbits_lhs;
+  dscr.ibits = nbits_rhs;
+  dscr.wsigned = false;
+  dscr.isigned = false;
+  dscr.M = nrows_lhs;
+  dscr.K = ncols;
+  dscr.N = nrows_rhs;
+  bismo_rt::init();
+  gemmbitserial::GEMMContext ctx = gemmbitserial::allocGEMMContext(
+    nrows_lhs, ncols, nrows_rhs, nbits_lhs, nbits_rhs, false, false
+  );
+  bismo_rt::LayerHandle id = bismo_rt::initMatMul(dscr);
+  bismo_rt::setLayerLHSConstant(id);
+  uint8_t * lhs = bismo_rt::getLayerLHSBuffer(id);
+  uint8_t * rhs = bismo_rt::getLayerRHSBuffer(id);
+  gemmbitserial::generateRandomVector(nbits_lhs, nrows_lhs*ncols, lhs);
+  ctx.lhs.importRegular(lhs);
+  bool all_OK = true;
+  for(size_t i = 0; i < nruns; i++) {
+    gemmbitserial::generateRandomVector(nbits_rhs, nrows_rhs*ncols, rhs);
+    ctx.rhs.importRegular(rhs);
+    gemmbitserial::gemmBitSerial(ctx);
+    bismo_rt::syncLayerLHSBuffer(id);
+    bismo_rt::syncLayerRHSBuffer(id);
+    bismo_rt::execMatMul(id);
+    bismo_rt::syncLayerResBuffer(id);
+    int32_t * accel_res = bismo_rt::getLayerResBuffer(id);
+    all_OK &= (memcmp(ctx.res, accel_res, nrows_lhs*nrows_rhs*sizeof(int32_t)) == 0);
+    // overwrite the host-side weights, should have no effect
+    memset(lhs, 0, nrows_lhs*ncols);
+  }
+  bismo_rt::deinitMatMul(id);
+  gemmbitserial::deallocGEMMContext(ctx);
+  bismo_rt::deinit();
+  cout << "Test " << (all_OK ? "succeeded" : "failed") << " (" << testName << ")" << endl;
+  return all_OK;
+}
+
+// submit one layer asynchronously and prepare the inputs of a second layer
+// while the first one is executing
+bool test_async_overlap(bismo_rt::HardwareConfig hwcfg) {
+  string testName = "async_overlap";
+  cout << "Starting test: " << testName << endl;
+  const size_t nlayers = 2;
+  const size_t nrows_lhs = 2*hwcfg.dpaDimLHS, nrows_rhs = 2*hwcfg.dpaDimRHS;
+  const size_t ncols = 1024, nbits_lhs = 2, nbits_rhs = 2;
+  bismo_rt::MatMulDescriptor dscr;
+  dscr.wbits = nbits_lhs;
+  dscr.ibits = nbits_rhs;
+  dscr.wsigned = false;
+  dscr.isigned = false;
+  dscr.M = nrows_lhs;
+  dscr.K = ncols;
+  dscr.N = nrows_rhs;
+  bismo_rt::init();
+  vector<gemmbitserial::GEMMContext> ctx;
+  vector<bismo_rt::LayerHandle> id;
+  for(size_t i = 0; i < nlayers; i++) {
+    ctx.push_back(gemmbitserial::allocGEMMContext(
+      nrows_lhs, ncols, nrows_rhs, nbits_lhs, nbits_rhs, false, false
+    ));
+    id.push_back(bismo_rt::initMatMul(dscr));
+  }
+  auto prepare = [&](size_t i) {
+    uint8_t * lhs = bismo_rt::getLayerLHSBuffer(id[i]);
+    uint8_t * rhs = bismo_rt::getLayerRHSBuffer(id[i]);
+    gemmbitserial::generateRandomVector(nbits_lhs, nrows_lhs*ncols, lhs);
+    gemmbitserial::generateRandomVector(nbits_rhs, nrows_rhs*ncols, rhs);
+    ctx[i].lhs.importRegular(lhs);
+    ctx[i].rhs.importRegular(rhs);
+    gemmbitserial::gemmBitSerial(ctx[i]);
+    bismo_rt::syncLayerLHSBuffer(id[i]);
+    bismo_rt::syncLayerRHSBuffer(id[i]);
+  };
+  prepare(0);
+  bismo_rt::CompletionHandle h = bismo_rt::submitMatMul(id[0]);
+  for(size_t i = 1; i < nlayers; i++) {
+    // host-side preparation of the next layer overlaps with execution
+    prepare(i);
+    bismo_rt::waitMatMul(h);
+    h = bismo_rt::submitMatMul(id[i]);
+  }
+  bool all_OK = bismo_rt::waitMatMul(h);
+  all_OK &= bismo_rt::pollMatMul(h);
+  for(size_t i = 0; i < nlayers; i++) {
+    bismo_rt::syncLayerResBuffer(id[i]);
+    int32_t * accel_res = bismo_rt::getLayerResBuffer(id[i]);
+    all_OK &= (memcmp(ctx[i].res, accel_res, nrows_lhs*nrows_rhs*sizeof(int32_t)) == 0);
+    bismo_rt::deinitMatMul(id[i]);
+    gemmbitserial::deallocGEMMContext(ctx[i]);
+  }
+  bismo_rt::deinit();
+  cout << "Test " << (all_OK ? "succeeded" : "failed") << " (" << testName << ")" << endl;
+  return all_OK;
+}
+
+// queue several layers of different shapes back-to-back without waiting
+// in between. the odd tile counts make consecutive layers start from
+// different buffer regions on the accelerator.
+bool test_back_to_back(bismo_rt::HardwareConfig hwcfg) {
+  string testName = "back_to_back";
+  cout << "Starting test: " << testName << endl;
+  const size_t nlayers = 6;
+  const size_t ncols = 512, nbits_lhs = 2, nbits_rhs = 3;
+  bismo_rt::init();
+  vector<gemmbitserial::GEMMContext> ctx;
+  vector<bismo_rt::LayerHandle> id;
+  vector<bismo_rt::CompletionHandle> h;
+  for(size_t i = 0; i < nlayers; i++) {
+    bismo_rt::MatMulDescriptor dscr;
+    dscr.wbits = nbits_lhs;
+    dscr.ibits = nbits_rhs;
+    dscr.wsigned = false;
+    dscr.isigned = (i % 2 == 1);
+    dscr.M = (1 + i % 2) * hwcfg.dpaDimLHS;
+    dscr.K = ncols;
+    dscr.N = (1 + i % 3) * hwcfg.dpaDimRHS;
+    ctx.push_back(gemmbitserial::allocGEMMContext(
+      dscr.M, dscr.K, dscr.N, nbits_lhs, nbits_rhs, dscr.wsigned, dscr.isigned
+    ));
+    id.push_back(bismo_rt::initMatMul(dscr));
+    uint8_t * lhs = bismo_rt::getLayerLHSBuffer(id[i]);
+    uint8_t * rhs = bismo_rt::getLayerRHSBuffer(id[i]);
+    gemmbitserial::generateRandomVector(nbits_lhs, dscr.M*dscr.K, lhs);
+    gemmbitserial::generateRandomVector(nbits_rhs, dscr.N*dscr.K, rhs);
+    ctx[i].lhs.importRegular(lhs);
+    ctx[i].rhs.importRegular(rhs);
+    gemmbitserial::gemmBitSerial(ctx[i]);
+    bismo_rt::syncLayerLHSBuffer(id[i]);
+    bismo_rt::syncLayerRHSBuffer(id[i]);
+  }
+  for(size_t i = 0; i < nlayers; i++) {
+    h.push_back(bismo_rt::submitMatMul(id[i]));
+  }
+  bool all_OK = bismo_rt::waitMatMul(h[nlayers-1]);
+  for(size_t i = 0; i < nlayers; i++) {
+    // completions are in order, so all earlier layers must be done too
+    all_OK &= bismo_rt::pollMatMul(h[i]);
+    bismo_rt::syncLayerResBuffer(id[i]);
+    int32_t * accel_res = bismo_rt::getLayerResBuffer(id[i]);
+    size_t nbytes_res = ctx[i].lhs.nrows * ctx[i].rhs.nrows * sizeof(int32_t);
+    all_OK &= (memcmp(ctx[i].res, accel_res, nbytes_res) == 0);
+    bismo_rt::deinitMatMul(id[i]);
+    gemmbitserial::deallocGEMMContext(ctx[i]);
+  }
+  bismo_rt::deinit();
+  cout << "Test " << (all_OK ? "succeeded" : "failed") << " (" << testName << ")" << endl;
+  return all_OK;
+}
+
+// several threads each prepare, run and check their own layer at the same
+// time, sharing the accelerator
+bool test_multithreaded(bismo_rt::HardwareConfig hwcfg) {
+  string testName = "multithreaded";
+  cout << "Starting test: " << testName << endl;
+  const size_t nthreads = 4, niters = 4;
+  const size_t nbits_lhs = 2, nbits_rhs = 2;
+  bismo_rt::init();
+  // one flag per thread, vector<bool> would share bytes between threads
+  vector<char> ok(nthreads, 1);
+  auto worker = [&](size_t t) {
+    bismo_rt::MatMulDescriptor dscr;
+    dscr.wbits = nbits_lhs;
+    dscr.ibits = nbits_rhs;
+    dscr.wsigned = false;
+    dscr.isigned = (t % 2 == 1);
+    dscr.M = (1 + t % 2) * hwcfg.dpaDimLHS;
+    dscr.K = 256 * (1 + t);
+    dscr.N = (1 + t % 3) * hwcfg.dpaDimRHS;
+    gemmbitserial::GEMMContext ctx = gemmbitserial::allocGEMMContext(
+      dscr.M, dscr.K, dscr.N, nbits_lhs, nbits_rhs, dscr.wsigned, dscr.isigned
+    );
+    bismo_rt::LayerHandle id = bismo_rt::initMatMul(dscr);
+    uint8_t * lhs = bismo_rt::getLayerLHSBuffer(id);
+    uint8_t * rhs = bismo_rt::getLayerRHSBuffer(id);
+    for(size_t i = 0; i < niters; i++) {
+      gemmbitserial::generateRandomVector(nbits_lhs, dscr.M*dscr.K, lhs);
+      gemmbitserial::generateRandomVector(nbits_rhs, dscr.N*dscr.K, rhs);
+      ctx.lhs.importRegular(lhs);
+      ctx.rhs.importRegular(rhs);
+      gemmbitserial::gemmBitSerial(ctx);
+      bismo_rt::syncLayerLHSBuffer(id);
+      bismo_rt::syncLayerRHSBuffer(id);
+      bismo_rt::execMatMul(id);
+      bismo_rt::syncLayerResBuffer(id);
+      int32_t * accel_res = bismo_rt::getLayerResBuffer(id);
+      size_t nbytes_res = dscr.M * dscr.N * sizeof(int32_t);
+      ok[t] &= (memcmp(ctx.res, accel_res, nbytes_res) == 0);
+    }
+    bismo_rt::deinitMatMul(id);
+    gemmbitserial::deallocGEMMContext(ctx);
+  };
+  vector<std::thread> threads;
+  for(size_t t = 0; t < nthreads; t++) {
+    threads.push_back(std::thread(worker, t));
+  }
+  bool all_OK = true;
+  for(size_t t = 0; t < nthreads; t++) {
+    threads[t].join();
+    all_OK &= ok[t];
+  }
+  bismo_rt::deinit();
+  cout << "Test " << (all_OK ? "succeeded" : "failed") << " (" << testName << ")" << endl;
+  return all_OK;
+}
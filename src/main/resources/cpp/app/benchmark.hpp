@@ -69,6 +69,8 @@ bismo_rt::InstrumentationData run_benchmark_matmul(
   dscr.K = ncols;
   dscr.N = nrows_rhs;
   bismo_rt::init();
+  // report the per-stage breakdown as well
+  bismo_rt::setInstrumentationLevel(bismo_rt::instrDetailed);
   bismo_rt::InstrumentationData ret;
   try {
     bismo_rt::LayerHandle id = bismo_rt::initMatMul(dscr);
@@ -128,3 +130,34 @@ void benchmark_gemm_batch() {
     printInstrumentationData(ret);
   }
 }
+
+// small-K layers write out a result tile every few exec instructions, so the
+// exec stage waits for free result buffers (stg_exec_rcv). run a few of them
+// with 1 up to all of the result buffers in the hardware.
+void benchmark_result_buffers() {
+  bismo_rt::init();
+  bismo_rt::HardwareConfig hwcfg = bismo_rt::getHardwareConfig();
+  bismo_rt::deinit();
+  const size_t k = hwcfg.dpaDimCommon;
+  const size_t shapes[][3] = {
+    {8*hwcfg.dpaDimLHS, k, 8*hwcfg.dpaDimRHS},
+    {16*hwcfg.dpaDimLHS, 2*k, 4*hwcfg.dpaDimRHS},
+    {4*hwcfg.dpaDimLHS, k, 16*hwcfg.dpaDimRHS}
+  };
+  cout << "rows, depth, cols, bits, result_buffers, run_cycles, stg_exec_rcv, stg_result_run" << endl;
+  for(auto & shape : shapes) {
+    for(size_t bits = 1; bits <= 2; bits++) {
+      for(size_t nbufs = 1; nbufs <= hwcfg.resEntriesPerMem; nbufs++) {
+        bismo_rt::setExecResultBuffers(nbufs);
+        bismo_rt::InstrumentationData ret = run_benchmark_matmul(
+          shape[0], shape[2], shape[1], bits, bits
+        );
+        cout << shape[0] << delimiter << shape[1] << delimiter << shape[2];
+        cout << delimiter << bits << delimiter << nbufs;
+        cout << delimiter << ret["run_cycles"] << delimiter << ret["stg_exec_rcv"];
+        cout << delimiter << ret["stg_result_run"] << endl;
+      }
+    }
+  }
+  bismo_rt::setExecResultBuffers(0);
+}
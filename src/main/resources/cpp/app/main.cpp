@@ -40,24 +40,44 @@ int main(int argc, char const *argv[]) {
       cout << "t to run tests" << endl;
       cout << "i to run interactive benchmarking" << endl;
       cout << "b to run batch-mode benchmarking" << endl;
+      cout << "r to benchmark the number of exec-result buffers" << endl;
       return -1;
     }
     if(argv[1][0] == 'i') {
       benchmark_gemm_interactive();
     } else if(argv[1][0] == 'b') {
       benchmark_gemm_batch();
+    } else if(argv[1][0] == 'r') {
+      benchmark_result_buffers();
     } else if(argv[1][0] == 't') {
       bool all_OK = true;
       bismo_rt::init();
       bismo_rt::HardwareConfig hwcfg = bismo_rt::getHardwareConfig();
       all_OK &= bismo_rt::selftest_shared_buffer();
       all_OK &= bismo_rt::selftest_matrix();
+      all_OK &= bismo_rt::selftest_partial_sync();
+      all_OK &= bismo_rt::selftest_partial_readback();
+      all_OK &= bismo_rt::selftest_bind();
+      all_OK &= bismo_rt::selftest_accel_pool();
+      all_OK &= bismo_rt::selftest_plan_cache();
+      all_OK &= bismo_rt::selftest_histogram();
+      all_OK &= bismo_rt::selftest_extended_counter();
+      all_OK &= bismo_rt::selftest_memops();
+      all_OK &= bismo_rt::selftest_instrgen();
       all_OK &= bismo_rt::selftest_p2s();
       bismo_rt::deinit();
       // following tests call init/deinit themselves
       all_OK &= test_binary_onchip_onetile(hwcfg);
       all_OK &= test_multibit_onchip_onetile(hwcfg);
       all_OK &= test_multibit_multitile(hwcfg);
+      all_OK &= test_ktiling(hwcfg);
+      all_OK &= test_mntiling(hwcfg);
+      all_OK &= test_const_lhs(hwcfg);
+      all_OK &= test_async_overlap(hwcfg);
+      all_OK &= test_back_to_back(hwcfg);
+      all_OK &= test_multithreaded(hwcfg);
+      all_OK &= test_tiling_order(hwcfg);
+      all_OK &= test_host_instrgen(hwcfg);
       if(all_OK) {
         cout << "All tests passed succesfully" << endl;
       } else {
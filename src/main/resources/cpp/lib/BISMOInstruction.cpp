@@ -123,6 +123,14 @@ std::ostream& operator<<(std::ostream& os, const SingleMMDescriptor& dt)
   os << "OCM base addresses lhs rhs res: " << dt.base_l << " " << dt.base_r << " " << dt.base_res << std::endl;
   os << "DRAM addresses lhs rhs res: " << std::hex << dt.dram_lhs << " " << dt.dram_rhs << " " << dt.dram_res << std::dec << std::endl;
   os << "#buffers for latency hiding: " << (int) dt.nbufs_fetch_exec_log2 << std::endl;
+  os << "Tiling: ";
+  if(dt.tiling == tilingLHSRHS) {
+    os << "LHS-stationary" << std::endl;
+  } else if(dt.tiling == tilingLHSResident) {
+    os << "LHS-resident" << std::endl;
+  } else {
+    os << "RHS-stationary" << std::endl;
+  }
   os << "===========================" << std::endl;
   return os;
 }
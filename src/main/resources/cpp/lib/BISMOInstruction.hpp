@@ -40,6 +40,16 @@ enum BISMOTargetStage {
   stgFetch, stgExec, stgResult
 };
 
+// loop order over the result tiles of a descriptor. the outer loop walks the
+// stationary operand, which is fetched once per tile, while the inner loop
+// streams the tiles of the other operand past it.
+enum BISMOTiling {
+  tilingRHSLHS,     // RHS-stationary, LHS re-fetched for each RHS tile
+  tilingLHSRHS,     // LHS-stationary, RHS re-fetched for each LHS tile
+  tilingLHSResident // RHS-stationary, but the entire LHS is fetched once
+                    // into a single buffer region and reused for all RHS tiles
+};
+
 // these should match the values defined in BISMOLimits.scala
 #define BISMO_LIMIT_FETCHID_BITS    9
 #define BISMO_LIMIT_INBUFADDR_BITS  16
@@ -48,7 +58,7 @@ enum BISMOTargetStage {
 #define BISMO_LIMIT_DRAM_BCNT_BITS  8
 #define BISMO_LIMIT_DRAM_BOFF_BITS  24
 #define BISMO_LIMIT_MAXSHIFT_BITS   1
-#define BISMO_LIMIT_RESADDR_BITS    1
+#define BISMO_LIMIT_RESADDR_BITS    3
 #define BISMO_MMDESCR_BITS          208
 #define BISMO_INSTR_BITS            128
 
@@ -166,7 +176,7 @@ struct BISMOExecRunInstruction {
   ap_uint<1> negate;
   ap_uint<1> clear_before_first_accumulation;
   ap_uint<1> writeEn;
-  ap_uint<1> writeAddr;
+  ap_uint<BISMO_LIMIT_RESADDR_BITS> writeAddr;
 
   ap_uint<BISMO_INSTR_BITS> asRaw() {
     ap_uint<BISMO_INSTR_BITS> ret = 0;
@@ -180,7 +190,7 @@ struct BISMOExecRunInstruction {
     ret(120, 120) = negate;
     ret(121, 121) = clear_before_first_accumulation;
     ret(122, 122) = writeEn;
-    ret(123, 123) = writeAddr;
+    ret(125, 123) = writeAddr;
     return ret;
   }
 
@@ -195,7 +205,7 @@ struct BISMOExecRunInstruction {
     negate = ret(120, 120);
     clear_before_first_accumulation = ret(121, 121);
     writeEn = ret(122, 122);
-    writeAddr = ret(123, 123);
+    writeAddr = ret(125, 123);
   }
 
   BISMOExecRunInstruction() {
@@ -216,9 +226,9 @@ struct BISMOExecRunInstruction {
 struct BISMOResultRunInstruction {
   ap_uint<2> targetStage;
   ap_uint<1> isRunCfg;
-  ap_uint<59> unused0;
+  ap_uint<57> unused0;
   ap_uint<1> nop;
-  ap_uint<1> resmem_addr;
+  ap_uint<BISMO_LIMIT_RESADDR_BITS> resmem_addr;
   ap_uint<32> dram_base;
   ap_uint<16> dram_skip;
   ap_uint<16> waitCompleteBytes; // deprecated, do not use
@@ -227,9 +237,9 @@ struct BISMOResultRunInstruction {
     ap_uint<BISMO_INSTR_BITS> ret = 0;
     ret(1, 0) = targetStage;
     ret(2, 2) = isRunCfg;
-    ret(61, 3) = unused0;
-    ret(62, 62) = nop;
-    ret(63, 63) = resmem_addr;
+    ret(59, 3) = unused0;
+    ret(60, 60) = nop;
+    ret(63, 61) = resmem_addr;
     ret(95, 64) = dram_base;
     ret(111, 96) = dram_skip;
     ret(127, 112) = waitCompleteBytes;
@@ -239,9 +249,9 @@ struct BISMOResultRunInstruction {
   void fromRaw(ap_uint<BISMO_INSTR_BITS> ret) {
     targetStage = ret(1, 0);
     isRunCfg = ret(2, 2);
-    unused0 = ret(61, 3);
-    nop = ret(62, 62);
-    resmem_addr = ret(63, 63);
+    unused0 = ret(59, 3);
+    nop = ret(60, 60);
+    resmem_addr = ret(63, 61);
     dram_base = ret(95, 64);
     dram_skip = ret(111, 96);
     waitCompleteBytes = ret(127, 112);
@@ -275,8 +285,19 @@ struct SingleMMDescriptor {
   uint16_t base_l;
   uint16_t base_r;
   uint8_t base_res;
+  // K-split accumulation across descriptors: continue from the accumulator
+  // values left by the previous descriptor instead of clearing them, and
+  // keep the sums in the accumulators instead of writing them out. the
+  // accumulators hold a single result tile, so this needs descriptors with
+  // one result tile (tiles_m = tiles_n = 1). the accumulators are doubled
+  // between bit positions, so continuing is only exact if the previous
+  // descriptor had single-bit inputs and so does this one.
+  bool accumulate;
+  bool defer_writeback;
   // number of buffers for latency hiding
   uint8_t nbufs_fetch_exec_log2;
+  // loop order over the result tiles, see BISMOTiling
+  uint8_t tiling;
   // base pointers for source and result matrices
   uint32_t dram_lhs;
   uint32_t dram_rhs;
@@ -293,8 +314,11 @@ struct SingleMMDescriptor {
     raw(63, 63) = signed_r;
     raw(79, 64) = base_l;
     raw(95, 80) = base_r;
-    raw(103, 96) = base_res;
-    raw(111, 104) = nbufs_fetch_exec_log2;
+    raw(101, 96) = base_res;
+    raw(102, 102) = accumulate;
+    raw(103, 103) = defer_writeback;
+    raw(107, 104) = nbufs_fetch_exec_log2;
+    raw(111, 108) = tiling;
     raw(143, 112) = dram_lhs;
     raw(175, 144) = dram_rhs;
     raw(207, 176) = dram_res;
@@ -311,8 +335,11 @@ struct SingleMMDescriptor {
     signed_r = raw(63, 63);
     base_l = raw(79, 64);
     base_r = raw(95, 80);
-    base_res = raw(103, 96);
-    nbufs_fetch_exec_log2 = raw(111, 104);
+    base_res = raw(101, 96);
+    accumulate = raw(102, 102);
+    defer_writeback = raw(103, 103);
+    nbufs_fetch_exec_log2 = raw(107, 104);
+    tiling = raw(111, 108);
     dram_lhs = raw(143, 112);
     dram_rhs = raw(175, 144);
     dram_res = raw(207, 176);
@@ -39,6 +39,9 @@
 #include "platform.h"
 #include "BitSerialMatMulAccel.hpp"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 #include "gemmbitserial/gemmbitserial.hpp"
 #include "gemmbitserial/convbitserial.hpp"
 #include "BISMOInstruction.hpp"
@@ -48,7 +51,6 @@
 #define CMDFIFO_CAP               16
 #define FETCHEXEC_TOKENS_LOG2     2
 #define FETCHEXEC_TOKENS          (1 << FETCHEXEC_TOKENS_LOG2)
-#define EXECRES_TOKENS            2
 #define N_CTRL_STATES             4
 #define N_STAGES                  3
 #define FETCH_ADDRALIGN           8
@@ -60,6 +62,10 @@
 
 #define P2S_ALIGN                 64
 
+// clock frequency calibration: number of samples and length of each
+#define FCLK_CALIB_SAMPLES        5
+#define FCLK_CALIB_SAMPLE_US      1000
+
 typedef enum {
   csGetCmd = 0, csRun, csSend, csReceive
 } ControllerState;
@@ -73,6 +79,7 @@ typedef struct {
   uint64_t lhsEntriesPerMem;
   uint64_t maxShiftSteps;
   uint64_t readChanWidth;
+  uint64_t resEntriesPerMem;
   uint64_t rhsEntriesPerMem;
   uint64_t writeChanWidth;
 } HardwareCfg;
@@ -80,14 +87,45 @@ typedef struct {
 typedef uint64_t PackedBitGroupType;
 typedef int32_t ResultType;
 
+// extends a 32-bit hardware counter to 64 bits in software by adding up the
+// wrapped differences between reads. stays correct as long as the counter is
+// read at least once every 2^32 increments.
+class ExtendedCounter {
+public:
+  ExtendedCounter() {
+    reset();
+  }
+
+  void reset() {
+    m_last = 0;
+    m_value = 0;
+  }
+
+  uint64_t update(uint32_t raw) {
+    m_value += (uint32_t)(raw - m_last);
+    m_last = raw;
+    return m_value;
+  }
+
+protected:
+  uint32_t m_last;
+  uint64_t m_value;
+};
+
 class BitSerialMatMulAccelDriver {
 public:
-  BitSerialMatMulAccelDriver(WrapperRegDriver * platform) {
+  // pass calibrate = false to set the clock frequency later, either with
+  // measure_fclk() or from a known value with set_fclk_MHz()
+  BitSerialMatMulAccelDriver(WrapperRegDriver * platform, bool calibrate = true) {
     m_platform = platform;
     m_accel = new BitSerialMatMulAccel(m_platform);
     m_fclk = 200.0;
+    m_cc_enabled = false;
+    m_execres_tokens = 0;
     update_hw_cfg();
-    measure_fclk();
+    if(calibrate) {
+      measure_fclk();
+    }
   }
 
   ~BitSerialMatMulAccelDriver() {
@@ -107,6 +145,16 @@ public:
   }
 
   // write a descriptor into the instruction generator
+  // whether the descriptor / instruction queue can take another entry
+  // without pushSingleMMDescriptor / pushInstruction having to wait
+  bool dsc_ready() {
+    return m_accel->get_dsc_ready() == 1;
+  }
+
+  bool ins_ready() {
+    return m_accel->get_ins_ready() == 1;
+  }
+
   void pushSingleMMDescriptor(SingleMMDescriptor desc) {
     while(m_accel->get_dsc_ready() != 1);
     const ap_uint<BISMO_MMDESCR_BITS> raw = desc.asRaw();
@@ -149,20 +197,36 @@ public:
     }
   }
 
-  void measure_fclk() {
-    if(m_platform->platformID() == "EmuDriver" || m_platform->platformID() == "VerilatedEmuDriver") {
+  bool is_emulated() {
+    return m_platform->platformID() == "EmuDriver" || m_platform->platformID() == "VerilatedEmuDriver";
+  }
+
+  void measure_fclk(int samples = FCLK_CALIB_SAMPLES, int sample_us = FCLK_CALIB_SAMPLE_US) {
+    if(is_emulated()) {
       // hardware emulation:
       // pretend we are running at 200 MHz for performance reporting purposes
       m_fclk = 200.0;
     } else {
-      uint32_t cc_start = perf_get_cc();
+      // count cycles over a few short intervals of host time and take the
+      // median, which filters out intervals where the host was preempted.
+      // the cycle counter is read at both ends so that the register access
+      // latency cancels out.
+      std::vector<float> fclk;
+      perf_set_cc_enable(false);
       perf_set_cc_enable(true);
-      // sleep for one second of CPU time
-      usleep(1000000);
+      for(int i = 0; i < samples; i++) {
+        const uint64_t cc_start = perf_get_cc();
+        auto t_start = std::chrono::steady_clock::now();
+        usleep(sample_us);
+        const uint64_t cc_end = perf_get_cc();
+        auto t_end = std::chrono::steady_clock::now();
+        // cycles per microsecond = fclk in MHz
+        float us = std::chrono::duration<float, std::micro>(t_end - t_start).count();
+        fclk.push_back((float)(cc_end - cc_start) / us);
+      }
       perf_set_cc_enable(false);
-      uint32_t cc_end = perf_get_cc();
-      // million ticks per second = fclk in MHz
-      m_fclk = (float)(cc_end - cc_start) / 1000000.0;
+      std::sort(fclk.begin(), fclk.end());
+      m_fclk = fclk[fclk.size() / 2];
     }
   }
 
@@ -170,6 +234,11 @@ public:
     return m_fclk;
   }
 
+  // use a known clock frequency instead of measuring it
+  void set_fclk_MHz(float fclk) {
+    m_fclk = fclk;
+  }
+
   // allocate a GEMMContext compliant with the accelerator size
   gemmbitserial::GEMMContext allocGEMMContext(
     uint64_t lhsRows, uint64_t depth, uint64_t rhsRows,
@@ -191,31 +260,55 @@ public:
   // enable/disable the cycle counter
   // cleared on rising edge (i.e. 0->1 transition)
   // increments by 1 every cycle while enabled
+  // the hardware counters are 32 bits wide and wrap after about 20 seconds
+  // at 200 MHz, the functions below extend them to 64 bits. call
+  // perf_refresh() at least that often while the counter is enabled.
   void perf_set_cc_enable(bool e) {
+    if(e && !m_cc_enabled) {
+      // hardware clears the cycle and state counters on the rising edge
+      m_cc.reset();
+      for(int i = 0; i < N_CTRL_STATES; i++) {
+        m_fetch_cstate_ctr[i].reset();
+        m_exec_cstate_ctr[i].reset();
+        m_result_cstate_ctr[i].reset();
+      }
+    }
+    m_cc_enabled = e;
     m_accel->set_perf_cc_enable(e ? 1 : 0);
   }
 
   // return cycle count
-  uint32_t perf_get_cc() {
-    return m_accel->get_perf_cc();
+  uint64_t perf_get_cc() {
+    return m_cc.update(m_accel->get_perf_cc());
   }
 
   // get the number of cycles that elapsed in a given state
   // for each controller
 
-  uint32_t perf_fetch_stats(ControllerState s) {
+  uint64_t perf_fetch_stats(ControllerState s) {
     m_accel->set_perf_prf_fetch_sel((uint32_t) s);
-    return m_accel->get_perf_prf_fetch_count();
+    return m_fetch_cstate_ctr[s].update(m_accel->get_perf_prf_fetch_count());
   }
 
-  uint32_t perf_exec_stats(ControllerState s) {
+  uint64_t perf_exec_stats(ControllerState s) {
     m_accel->set_perf_prf_exec_sel((uint32_t) s);
-    return m_accel->get_perf_prf_exec_count();
+    return m_exec_cstate_ctr[s].update(m_accel->get_perf_prf_exec_count());
   }
 
-  uint32_t perf_result_stats(ControllerState s) {
+  uint64_t perf_result_stats(ControllerState s) {
     m_accel->set_perf_prf_res_sel((uint32_t) s);
-    return m_accel->get_perf_prf_res_count();
+    return m_result_cstate_ctr[s].update(m_accel->get_perf_prf_res_count());
+  }
+
+  // read all performance counters once so that none of them can wrap
+  // unnoticed
+  void perf_refresh() {
+    perf_get_cc();
+    for(int i = 0; i < N_CTRL_STATES; i++) {
+      perf_fetch_stats((ControllerState) i);
+      perf_exec_stats((ControllerState) i);
+      perf_result_stats((ControllerState) i);
+    }
   }
 
   const size_t get_lhs_total_BRAM_bytes() {
@@ -296,6 +389,7 @@ public:
       ASSERT_BITS(f.clear_before_first_accumulation, 1);
       ASSERT_BITS(f.writeEn, 1);
       ASSERT_BITS(f.writeAddr, BISMO_LIMIT_RESADDR_BITS);
+      assert(f.writeAddr < m_cfg.resEntriesPerMem);
     } else {
       assert(s.chanID == 0 || s.chanID == 1);
       assert(s.unused0 == 0);
@@ -313,6 +407,7 @@ public:
       r.fromRaw(ins);
       // ensure all fields are within limits
       ASSERT_BITS(r.resmem_addr, BISMO_LIMIT_RESADDR_BITS);
+      assert(r.resmem_addr < m_cfg.resEntriesPerMem);
       ASSERT_BITS(r.dram_base, BISMO_LIMIT_DRAMADDR_BITS);
       ASSERT_BITS(r.dram_skip, BISMO_LIMIT_DRAM_BSIZE_BITS);
       // ensure all DRAM accesses are aligned to 8 bytes
@@ -335,6 +430,10 @@ public:
   const uint32_t res_opcount() {
     return m_accel->get_result_op_count();
   }
+  // number of descriptors completed by the result stage since reset
+  const uint32_t res_dsccount() {
+    return m_accel->get_result_dsc_count();
+  }
 
   // reset the accelerator
   void reset() {
@@ -396,17 +495,29 @@ public:
 
   // initialize the tokens in FIFOs representing shared resources
   // this also serves as a sanity check for basic functionality in the hardware
-  void init_resource_pools() {
+  // execres_tokens is the number of exec-result buffers to use, 0 for all
+  // the result memory has. using fewer is only useful for benchmarking.
+  void init_resource_pools(size_t execres_tokens = 0) {
+    if(execres_tokens == 0) {
+      execres_tokens = m_cfg.resEntriesPerMem;
+    }
+    assert(execres_tokens <= m_cfg.resEntriesPerMem);
+    m_execres_tokens = execres_tokens;
     set_stage_enables(0, 0, 0);
     for(int i = 0; i < FETCHEXEC_TOKENS; i++) {
       add_token_fetchexec_free();
     }
     while(m_accel->get_tc_ef() != FETCHEXEC_TOKENS);
 
-    for(int i = 0; i < EXECRES_TOKENS; i++) {
+    for(size_t i = 0; i < m_execres_tokens; i++) {
       add_token_execresult_free();
     }
-    while(m_accel->get_tc_re() != EXECRES_TOKENS);
+    while(m_accel->get_tc_re() != m_execres_tokens);
+  }
+
+  // number of exec-result buffers in use, see init_resource_pools
+  size_t execres_tokens() const {
+    return m_execres_tokens;
   }
 
   // get the instantiated hardware config
@@ -430,7 +541,7 @@ public:
     }
   }
 
-  uint32_t getStateBreakdown(BISMOTargetStage stg, int state) {
+  uint64_t getStateBreakdown(BISMOTargetStage stg, int state) {
     switch (stg) {
       case stgFetch:
         return m_fetch_cstate_cycles[state];
@@ -509,7 +620,9 @@ void setup_p2s(
   uint32_t rows,
   uint32_t cols,
   uint32_t bit_width,
-  bool issigned
+  bool issigned,
+  // byte offset between destination bit planes, 0 = rows * cols / 8
+  uint32_t dst_bitplane_stride = 0
 ) {
   // ensure #cols is divisible by P2S_ALIGN
   assert(cols % P2S_ALIGN == 0);
@@ -523,6 +636,7 @@ void setup_p2s(
   m_accel->set_cmdqueue_bits_actualPrecision(bit_width);
   m_accel->set_cmdqueue_bits_waitCompleteBytes(nbytes);
   m_accel->set_cmdqueue_bits_signed(issigned ? 1 : 0);
+  m_accel->set_cmdqueue_bits_dstBitplaneStride(dst_bitplane_stride);
   // wait until cmdqueue is available
   while(m_accel->get_cmdqueue_ready() != 1);
   // pulse cmdqueue.valid
@@ -530,9 +644,14 @@ void setup_p2s(
   m_accel->set_cmdqueue_valid(false);
 }
 
-uint32_t p2s_exec_and_wait() {
+// start executing the p2s command set up by setup_p2s, without waiting
+void p2s_start() {
   m_accel->set_enable(1);
   m_accel->set_ackqueue_ready(false);
+}
+
+// wait for a started p2s command to finish, returns its cycle count
+uint32_t p2s_wait() {
   while(m_accel->get_ackqueue_valid() != 1);
   uint32_t ret = m_accel->get_ackqueue_bits();
   // pulse ackqueue.ready to consume ack token
@@ -542,17 +661,29 @@ uint32_t p2s_exec_and_wait() {
   return ret;
 }
 
+uint32_t p2s_exec_and_wait() {
+  p2s_start();
+  return p2s_wait();
+}
+
 /************************** END P2S driver section **************************/
 
 protected:
   BitSerialMatMulAccel * m_accel;
   WrapperRegDriver * m_platform;
   HardwareCfg m_cfg;
+  size_t m_execres_tokens;
   float m_fclk;
   // performance counter variables
-  uint32_t m_fetch_cstate_cycles[N_CTRL_STATES];
-  uint32_t m_exec_cstate_cycles[N_CTRL_STATES];
-  uint32_t m_result_cstate_cycles[N_CTRL_STATES];
+  uint64_t m_fetch_cstate_cycles[N_CTRL_STATES];
+  uint64_t m_exec_cstate_cycles[N_CTRL_STATES];
+  uint64_t m_result_cstate_cycles[N_CTRL_STATES];
+  // software extensions of the 32-bit hardware counters
+  bool m_cc_enabled;
+  ExtendedCounter m_cc;
+  ExtendedCounter m_fetch_cstate_ctr[N_CTRL_STATES];
+  ExtendedCounter m_exec_cstate_ctr[N_CTRL_STATES];
+  ExtendedCounter m_result_cstate_ctr[N_CTRL_STATES];
 
   // get the instantiated hardware config from accelerator
   void update_hw_cfg() {
@@ -564,6 +695,7 @@ protected:
     m_cfg.lhsEntriesPerMem = m_accel->get_hw_lhsEntriesPerMem();
     m_cfg.maxShiftSteps = m_accel->get_hw_maxShiftSteps();
     m_cfg.readChanWidth = m_accel->get_hw_readChanWidth();
+    m_cfg.resEntriesPerMem = m_accel->get_hw_resEntriesPerMem();
     m_cfg.rhsEntriesPerMem = m_accel->get_hw_rhsEntriesPerMem();
     m_cfg.writeChanWidth = m_accel->get_hw_writeChanWidth();
   }
@@ -30,6 +30,8 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "bismo_rt_internal.hpp"
+#include <fstream>
+#include <sstream>
 
 namespace bismo_rt {
 TIMER_INIT();
@@ -37,30 +39,136 @@ TIMER_INIT();
 WrapperRegDriver * platform;
 BitSerialMatMulAccelDriver * acc;
 HardwareCfg cfg;
-std::map<std::string,float> instrumentationData;
+CompletionMonitor * monitor;
+AccelBufferPool * pool;
+PlanCache * plans;
+InstrGen * igen;
+#ifdef BISMORT_USE_HOST_INSTRGEN
+InstrGenSource instrgen_source = instrGenHost;
+#else
+InstrGenSource instrgen_source = instrGenHW;
+#endif
+thread_local InstrumentationData instrumentationData;
+// clock frequency settings, see setFclkOverride and setFclkCache
+float fclk_override = 0;
+// number of exec-result buffers to use, see setExecResultBuffers
+size_t execres_buffers = 0;
+std::string fclk_cache_file;
+std::string fclk_bitfile_id;
+
+void setFclkOverride(float fclk_mhz) {
+  fclk_override = fclk_mhz;
+}
+
+void setFclkCache(const std::string & filename, const std::string & bitfile_id) {
+  // the cache file separates key and frequency by whitespace
+  if(bitfile_id.find_first_of(" \t\r\n\v\f") != std::string::npos) {
+    throw "Bitfile id for the fclk cache must not contain whitespace";
+  }
+  fclk_cache_file = filename;
+  fclk_bitfile_id = bitfile_id;
+}
+
+void setExecResultBuffers(size_t nbufs) {
+  execres_buffers = nbufs;
+}
+
+// key for the fclk cache, setFclkCache rejects bitfile ids with whitespace
+std::string fclk_cache_key() {
+  std::ostringstream key;
+  key << platform->platformID() << "/" << fclk_bitfile_id << "/";
+  key << cfg.accWidth << "-" << cfg.cmdQueueEntries << "-" << cfg.dpaDimCommon;
+  key << "-" << cfg.dpaDimLHS << "-" << cfg.dpaDimRHS << "-";
+  key << cfg.lhsEntriesPerMem << "-" << cfg.rhsEntriesPerMem << "-";
+  key << cfg.maxShiftSteps << "-" << cfg.readChanWidth << "-";
+  key << cfg.resEntriesPerMem << "-" << cfg.writeChanWidth;
+  return key.str();
+}
+
+// set the accelerator clock frequency from the override, the cache file or
+// a measurement, in that order
+void calibrate_fclk() {
+  if(fclk_override > 0) {
+    acc->set_fclk_MHz(fclk_override);
+    return;
+  }
+  if(fclk_cache_file.empty() || acc->is_emulated()) {
+    acc->measure_fclk();
+    return;
+  }
+  const std::string key = fclk_cache_key();
+  std::ifstream in(fclk_cache_file.c_str());
+  std::string line;
+  while(std::getline(in, line)) {
+    // one "key fclk" entry per line, malformed lines are skipped
+    std::istringstream entry(line);
+    std::string entry_key;
+    float entry_fclk;
+    if(!(entry >> entry_key >> entry_fclk) || entry_fclk <= 0) {
+      continue;
+    }
+    if(entry_key == key) {
+      acc->set_fclk_MHz(entry_fclk);
+      return;
+    }
+  }
+  acc->measure_fclk();
+  // a new key is appended, a failure to write only costs the next init time
+  std::ofstream out(fclk_cache_file.c_str(), std::ios::app);
+  out << key << " " << acc->fclk_MHz() << std::endl;
+}
 
 // global init/deinit for the runtime library
 void init() {
   platform = initPlatform();
-  acc = new BitSerialMatMulAccelDriver(platform);
+  acc = new BitSerialMatMulAccelDriver(platform, false);
   acc->reset();
-  // currently the runtime is implemented with direct instruction feed
-  // will switch to descriptors when the correct generators are impl'd
-  acc->init_resource_pools();
-  acc->useDirectInstructionFeed();
+  if(execres_buffers > acc->hwcfg().resEntriesPerMem) {
+    delete acc;
+    deinitPlatform(platform);
+    throw "More exec-result buffers requested than available in hardware";
+  }
+  // the feed mode (descriptors or instructions) is set by CompletionMonitor::submit
+  acc->init_resource_pools(execres_buffers);
   cfg = acc->hwcfg();
+  calibrate_fclk();
+  monitor = new CompletionMonitor();
+  // starts out in the same state as the generators in the bitfile
+  igen = new InstrGen(cfg);
+  pool = new AccelBufferPool(platform);
+  plans = new PlanCache(BISMORT_PLAN_CACHE_BYTES);
   // allocate shared buffer for p2s
-  accel_p2s_bitpar_buffer = (uint32_t)(uint64_t) platform->allocAccelBuffer(BISMORT_P2S_BITPAR_BYTES);
-  host_p2s_bitpar_buffer = new uint8_t[BISMORT_P2S_BITPAR_BYTES];
+  accel_p2s_bitpar_buffer = pool->alloc(BISMORT_P2S_BITPAR_BYTES);
 }
 
 void deinit() {
+  monitor->drain();
+  // cached layers hold accelerator buffers from the pool
+  delete plans;
+  setTracing(false);
+  delete trace_buffer;
+  trace_buffer = 0;
+  delete monitor;
+  delete igen;
   delete acc;
-  delete [] host_p2s_bitpar_buffer;
-  platform->deallocAccelBuffer((void *) accel_p2s_bitpar_buffer);
+  pool->dealloc(accel_p2s_bitpar_buffer);
+  // gives all accelerator buffers back to the platform
+  delete pool;
   deinitPlatform(platform);
 }
 
+void setInstrGenSource(InstrGenSource src) {
+  // the instruction feed is chosen when the pipeline is started, see
+  // CompletionMonitor::submit
+  std::unique_lock<std::mutex> lock = monitor->lock_idle();
+  instrgen_source = src;
+}
+
+InstrGenSource getInstrGenSource() {
+  std::unique_lock<std::mutex> lock = monitor->lock();
+  return instrgen_source;
+}
+
 void benchmark_host_accel_transfer() {
   std::vector<size_t> vsize {1, 2, 4, 8, 16, 32};
   for(auto & s : vsize) {
@@ -91,6 +199,7 @@ HardwareConfig getHardwareConfig() {
   ret.lhsEntriesPerMem = cfg.lhsEntriesPerMem;
   ret.maxShiftSteps = cfg.maxShiftSteps;
   ret.readChanWidth = cfg.readChanWidth;
+  ret.resEntriesPerMem = cfg.resEntriesPerMem;
   ret.rhsEntriesPerMem = cfg.rhsEntriesPerMem;
   ret.writeChanWidth = cfg.writeChanWidth;
   return ret;
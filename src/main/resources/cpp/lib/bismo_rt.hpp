@@ -39,6 +39,19 @@ namespace bismo_rt {
 // global init/deinit for the runtime library
 void init();
 void deinit();
+// init() measures the accelerator clock frequency in a few milliseconds.
+// call these before init() to skip that: a nonzero override is used as the
+// frequency in MHz. with a cache file, the first init() stores its
+// measurement there keyed by platform, hardware config and bitfile_id (e.g.
+// the bitfile name or checksum, without whitespace), and later init()s with
+// the same key load it.
+void setFclkOverride(float fclk_mhz);
+void setFclkCache(const std::string & filename, const std::string & bitfile_id = "");
+// init() lets the exec stage use all result buffers of the hardware (see
+// HardwareConfig::resEntriesPerMem). call this before init() to use only the
+// first nbufs of them, e.g. to measure the exec stage stalls for fewer
+// buffers. 0 uses all of them.
+void setExecResultBuffers(size_t nbufs);
 
 // descriptor for the shape/size/precision of a matrix multiplication
 typedef struct {
@@ -53,26 +66,116 @@ typedef struct {
 // handle representing a particular layer instance that BISMO knows
 // how to execute
 typedef uint64_t LayerHandle;
-// initialize matrix multiplication and return handle
+// initialize matrix multiplication and return handle. reuses the buffers
+// and descriptors of a previously deinitialized layer of the same shape,
+// precision and signedness if there is one, in which case the contents of
+// the buffers are not cleared.
 LayerHandle initMatMul(MatMulDescriptor & dsc);
 // get host-accessible buffers associated with layer
 uint8_t * getLayerLHSBuffer(LayerHandle id);
 uint8_t * getLayerRHSBuffer(LayerHandle id);
 int32_t * getLayerResBuffer(LayerHandle id);
 // synchronize buffers associated with layer:
+// read the LHS/RHS of a layer straight from caller memory on its syncs,
+// instead of the buffers above, without copying it into the runtime first.
+// row i of the LHS (column j of the col-major RHS) starts at
+// ptr + i * row_stride, 0 meaning densely packed. the memory must stay valid
+// until the layer is destroyed or another buffer is bound, ptr = 0 goes back
+// to the runtime buffer. the next sync converts the whole matrix.
+void bindLayerLHSBuffer(LayerHandle id, const uint8_t * ptr, size_t row_stride = 0);
+void bindLayerRHSBuffer(LayerHandle id, const uint8_t * ptr, size_t col_stride = 0);
+// allocate memory that the accelerator can read directly, to place tensors
+// there in the first place. bound buffers in it with K aligned to
+// getHardwareConfig().dpaDimCommon (and a row stride of K), with M and N
+// aligned to dpaDimLHS and dpaDimRHS, are converted in place. returns 0 if
+// the platform has no such memory (no cache coherence). free the buffer
+// before deinit().
+uint8_t * allocSharedBuffer(size_t nbytes);
+void freeSharedBuffer(uint8_t * ptr);
 // ensure that input (LHS/RHS) buffers are up-to-date on the accelerator
 void syncLayerLHSBuffer(LayerHandle id);
 void syncLayerRHSBuffer(LayerHandle id);
 // ensure that result buffer is up-to-date on the host
 void syncLayerResBuffer(LayerHandle id);
+// as above, but only for rows [row0, row0 + nrows) and columns
+// [col0, col0 + ncols) of the result. the rest of the result buffer is left
+// as it is.
+void syncLayerResRegion(
+  LayerHandle id, size_t row0, size_t nrows, size_t col0, size_t ncols
+);
+// only transfer and convert part of an input buffer on its next sync: rows
+// [row_begin, row_end) of the LHS or columns [col_begin, col_end) of the RHS.
+// can be called several times before a sync to add more ranges. without a
+// marked range a sync converts the whole buffer, and so does the first one.
+void markLayerLHSDirty(LayerHandle id, size_t row_begin, size_t row_end);
+void markLayerRHSDirty(LayerHandle id, size_t col_begin, size_t col_end);
+// mark input buffers as constant (e.g. weights): the next sync transfers
+// and converts them as usual, after that syncs do nothing and the bit-serial
+// data stays on the accelerator. call again to load new contents once.
+void setLayerLHSConstant(LayerHandle id, bool is_const = true);
+void setLayerRHSConstant(LayerHandle id, bool is_const = true);
 // execute layer with given handle
 void execMatMul(LayerHandle id);
+// handle representing a layer execution that was submitted asynchronously
+typedef uint64_t CompletionHandle;
+// start executing layer with given handle and return without waiting for
+// the accelerator to finish. the host is free to e.g. prepare the inputs of
+// another layer in the meantime. several layers can be submitted in a row
+// and execute back-to-back, finishing in submission order. the cycle counts
+// in the instrumentation come from 32-bit hardware counters that wrap every
+// 2^32 cycles (about 20 seconds at 200 MHz). the runtime reads them on each
+// submit, poll and wait, so while layers are in flight call one of these at
+// least every BISMORT_PERF_REFRESH_MS or the cycle counts may be too low.
+CompletionHandle submitMatMul(LayerHandle id);
+// check whether a submitted layer execution has finished, does not block
+bool pollMatMul(CompletionHandle h);
+// wait until a submitted layer execution has finished or timeout_us
+// microseconds have passed (0 = no timeout). returns true if finished.
+bool waitMatMul(CompletionHandle h, uint64_t timeout_us = 0);
 // struct representing all instrumentation data from the previous run
 typedef std::map<std::string,float> InstrumentationData;
 // retrieve a map of all instrumentation data from the previous run
 InstrumentationData getInstrumentationData(LayerHandle id);
-// destroy layer with given handle
+// latency distributions over all runs of a layer since it was created or
+// its stats were last reset. times are in microseconds, accelerator time in
+// cycles. pad, host2accel, p2s and accel2host are recorded once per matrix,
+// end-to-end from the first input sync (or submit) of a run until its
+// results are synced. only recorded if instrumentation is not off.
+typedef enum {
+  latEndToEnd, latPad, latHost2Accel, latP2S, latAccelCycles, latAccel2Host,
+  latCount
+} LatencyMetric;
+typedef struct {
+  uint64_t count;
+  float p50, p90, p99, max;
+} LatencySummary;
+typedef struct {
+  LatencySummary metric[latCount];
+} LatencyStats;
+LatencyStats getLatencyStats(LayerHandle id);
+void resetLatencyStats(LayerHandle id);
+// record a timeline of runtime phases (pad, copies, p2s, descriptor push,
+// waiting for execution, unpad), layer runs on the accelerator and sampled
+// accelerator stage activity into a ring buffer. enabling clears the buffer.
+void setTracing(bool enable);
+// write the buffered trace as Chrome trace JSON, e.g. for chrome://tracing
+// or ui.perfetto.dev. returns false if tracing was never enabled or the file
+// could not be written.
+bool dumpTrace(const std::string & filename);
+// how much instrumentation data is recorded: nothing, host-side phase times
+// and run cycles (summary), or additionally totals and call counts for each
+// and the per-stage accelerator breakdown (detailed)
+typedef enum {
+  instrOff, instrSummary, instrDetailed
+} InstrumentationLevel;
+void setInstrumentationLevel(InstrumentationLevel level);
+InstrumentationLevel getInstrumentationLevel();
+// destroy layer with given handle. its buffers are kept for reuse by a later
+// initMatMul of the same shape, see setPlanCacheBytes.
 void deinitMatMul(LayerHandle id);
+// max accelerator memory kept by destroyed layers for reuse, the least
+// recently destroyed ones are freed first. 0 frees them right away.
+void setPlanCacheBytes(size_t nbytes);
 
 // struct with details of currently instantiated hardware config
 // copied from BitSerialMatMulAccelDriver in order not to have that as a
@@ -86,6 +189,7 @@ typedef struct {
   uint64_t lhsEntriesPerMem;  // number of entries in LHS on-chip memory
   uint64_t maxShiftSteps;     // obsolete, do not use
   uint64_t readChanWidth;     // max bits read from DRAM per cycle
+  uint64_t resEntriesPerMem;  // number of exec-result buffers
   uint64_t rhsEntriesPerMem;  // number of entries in RHS on-chip memory
   uint64_t writeChanWidth;    // max bits written to DRAM per cycle
 } HardwareConfig;
@@ -93,11 +197,47 @@ typedef struct {
 HardwareConfig getHardwareConfig();
 // benchmark host<->accel transfer times
 void benchmark_host_accel_transfer();
+// backends for parallel-to-serial conversion of the input matrices: the p2s
+// accelerator, a multithreaded SIMD transpose on the CPU, or choose per call
+// based on the measured cost of both (default)
+typedef enum {
+  p2sBackendAuto, p2sBackendHW, p2sBackendSW
+} P2SBackend;
+void setP2SBackend(P2SBackend backend);
+P2SBackend getP2SBackend();
+// where the accelerator instructions come from: the instruction generators
+// in the bitfile (default), or the host, which generates them in software
+// and feeds them to the accelerator directly. the host generator can use
+// other tiling schedules without a new bitfile. only call after init(),
+// waits for the accelerator to become idle.
+typedef enum {
+  instrGenHW, instrGenHost
+} InstrGenSource;
+void setInstrGenSource(InstrGenSource src);
+InstrGenSource getInstrGenSource();
 // run a small self-test for the p2s accelerator
 bool selftest_p2s();
 // run self-test for buffer copy operations
 bool selftest_shared_buffer();
+// run self-test for the host-side instruction generator
+bool selftest_instrgen();
 // run self-test for matrix pad and copy operations
 bool selftest_matrix();
+// run self-test for syncing only the dirty parts of a matrix
+bool selftest_partial_sync();
+// run self-test for reading back part of a matrix
+bool selftest_partial_readback();
+// run self-test for reading a matrix from strided caller memory
+bool selftest_bind();
+// run self-test for the accelerator buffer pool
+bool selftest_accel_pool();
+// run self-test for reusing deinitialized layers
+bool selftest_plan_cache();
+// run self-test for the latency histograms
+bool selftest_histogram();
+// run self-test for the 64-bit extension of the hardware counters
+bool selftest_extended_counter();
+// run self-test for the device-safe copy and zero kernels
+bool selftest_memops();
 }
 #endif
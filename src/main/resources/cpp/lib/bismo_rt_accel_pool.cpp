@@ -0,0 +1,226 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_accel_pool.hpp"
+#include "bismo_rt_options.hpp"
+#include <iterator>
+
+namespace bismo_rt {
+
+AccelBufferPool::AccelBufferPool(WrapperRegDriver * platform) {
+  m_platform = platform;
+  m_free_seq = 0;
+  m_bytes_free = 0;
+  m_max_free_bytes = BISMORT_ACCEL_POOL_MAX_FREE_BYTES;
+  m_bytes_reserved = 0;
+  m_bytes_in_use = 0;
+  m_num_reused = 0;
+  m_num_platform_allocs = 0;
+}
+
+AccelBufferPool::~AccelBufferPool() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  for(auto & u : m_used) {
+    m_platform->deallocAccelBuffer((void *) u.first);
+  }
+  m_used.clear();
+  trim(0);
+}
+
+size_t AccelBufferPool::size_class(size_t nbytes) {
+  if(nbytes <= BISMORT_ACCEL_POOL_MIN_BYTES) {
+    return BISMORT_ACCEL_POOL_MIN_BYTES;
+  }
+  // four classes per power of two, which bounds the rounding overhead to 25%
+  size_t p2 = 1;
+  while((p2 << 1) <= nbytes) {
+    p2 <<= 1;
+  }
+  const size_t step = p2 / 4;
+  return ((nbytes + step - 1) / step) * step;
+}
+
+uint32_t AccelBufferPool::alloc(size_t nbytes) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  const size_t sc = size_class(nbytes);
+  uint32_t ret;
+  auto it = m_free.find(sc);
+  if(it != m_free.end()) {
+    // the most recently freed one
+    auto newest = std::prev(it->second.end());
+    ret = newest->second;
+    m_free_order.erase(newest->first);
+    it->second.erase(newest);
+    if(it->second.empty()) {
+      m_free.erase(it);
+    }
+    m_bytes_free -= sc;
+    m_num_reused++;
+  } else {
+    ret = (uint32_t)(uint64_t) m_platform->allocAccelBuffer(sc);
+    if(ret == 0) {
+      // free buffers of other size classes may be what is missing
+      trim(0);
+      ret = (uint32_t)(uint64_t) m_platform->allocAccelBuffer(sc);
+      if(ret == 0) {
+        throw "Failed to allocate accelerator buffer";
+      }
+    }
+    m_bytes_reserved += sc;
+    m_num_platform_allocs++;
+  }
+  m_used[ret] = std::make_pair(sc, nbytes);
+  m_bytes_in_use += nbytes;
+  return ret;
+}
+
+void AccelBufferPool::dealloc(uint32_t accelbuf) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  auto it = m_used.find(accelbuf);
+  if(it == m_used.end()) {
+    throw "Buffer was not allocated from the AccelBufferPool";
+  }
+  const size_t sc = it->second.first;
+  m_bytes_in_use -= it->second.second;
+  m_used.erase(it);
+  const uint64_t seq = m_free_seq++;
+  m_free[sc][seq] = accelbuf;
+  m_free_order[seq] = sc;
+  m_bytes_free += sc;
+  trim(m_max_free_bytes);
+}
+
+void AccelBufferPool::trim(size_t nbytes) {
+  while(m_bytes_free > nbytes) {
+    auto oldest = m_free_order.begin();
+    const size_t sc = oldest->second;
+    auto f = m_free.find(sc);
+    m_platform->deallocAccelBuffer((void *) f->second[oldest->first]);
+    f->second.erase(oldest->first);
+    if(f->second.empty()) {
+      m_free.erase(f);
+    }
+    m_free_order.erase(oldest);
+    m_bytes_free -= sc;
+    m_bytes_reserved -= sc;
+  }
+}
+
+void AccelBufferPool::release() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  trim(0);
+}
+
+void AccelBufferPool::set_max_free_bytes(size_t nbytes) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_max_free_bytes = nbytes;
+  trim(m_max_free_bytes);
+}
+
+size_t AccelBufferPool::max_free_bytes() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_max_free_bytes;
+}
+
+size_t AccelBufferPool::bytes_free() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_bytes_free;
+}
+
+uint8_t * AccelBufferPool::alloc_shared(size_t nbytes) {
+  if(!m_platform->is_coherent()) {
+    return 0;
+  }
+  const uint32_t accelbuf = alloc(nbytes);
+  uint8_t * hostbuf = (uint8_t *) m_platform->phys2virt((void *) accelbuf);
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_shared[hostbuf] = std::make_pair(accelbuf, nbytes);
+  return hostbuf;
+}
+
+void AccelBufferPool::dealloc_shared(uint8_t * hostbuf) {
+  uint32_t accelbuf;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_shared.find(hostbuf);
+    if(it == m_shared.end()) {
+      throw "Buffer was not allocated as a shared buffer";
+    }
+    accelbuf = it->second.first;
+    m_shared.erase(it);
+  }
+  dealloc(accelbuf);
+}
+
+uint32_t AccelBufferPool::shared_accelbuf(const uint8_t * ptr, size_t nbytes) const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  // the last buffer starting at or before ptr
+  auto it = m_shared.upper_bound(ptr);
+  if(it == m_shared.begin()) {
+    return 0;
+  }
+  it--;
+  const size_t offset = ptr - it->first;
+  if(offset + nbytes > it->second.second) {
+    return 0;
+  }
+  return it->second.first + offset;
+}
+
+size_t AccelBufferPool::bytes_reserved() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_bytes_reserved;
+}
+
+size_t AccelBufferPool::bytes_in_use() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_bytes_in_use;
+}
+
+float AccelBufferPool::fragmentation() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if(m_bytes_reserved == 0) {
+    return 0;
+  }
+  return 1.0f - (float) m_bytes_in_use / (float) m_bytes_reserved;
+}
+
+size_t AccelBufferPool::num_reused() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_num_reused;
+}
+
+size_t AccelBufferPool::num_platform_allocs() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_num_platform_allocs;
+}
+
+}
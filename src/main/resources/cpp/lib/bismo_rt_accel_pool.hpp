@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_ACCEL_POOL_HPP
+#define BISMORT_ACCEL_POOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <mutex>
+#include "wrapperregdriver.h"
+
+namespace bismo_rt {
+
+// pool allocator for accelerator-side buffers. allocating contiguous memory
+// from the platform is slow and fragments it over time, so freed buffers are
+// kept in per-size-class free lists and handed out again to later requests
+// of the same size class. the free lists hold at most max_free_bytes(), the
+// buffers freed the longest time ago are returned to the platform first. all
+// free buffers are returned if the platform runs out of memory, on release()
+// or when the pool is destroyed. safe to use from several threads.
+class AccelBufferPool {
+public:
+  AccelBufferPool(WrapperRegDriver * platform);
+  // releases all buffers, including ones that are still in use
+  ~AccelBufferPool();
+  // allocate an accelerator buffer of at least nbytes
+  uint32_t alloc(size_t nbytes);
+  // return a buffer obtained from alloc() to the pool
+  void dealloc(uint32_t accelbuf);
+  // give all currently unused buffers back to the platform
+  void release();
+  // change how many bytes the free lists may hold, trimming them right away
+  void set_max_free_bytes(size_t nbytes);
+  size_t max_free_bytes() const;
+  // bytes sitting in the free lists
+  size_t bytes_free() const;
+  // allocate a buffer that the host can also access, returns its host
+  // address or 0 if the platform has no coherent memory
+  uint8_t * alloc_shared(size_t nbytes);
+  // return a buffer obtained from alloc_shared() to the pool
+  void dealloc_shared(uint8_t * hostbuf);
+  // accelerator address of host memory [ptr, ptr + nbytes) if it lies within
+  // a buffer from alloc_shared(), 0 otherwise
+  uint32_t shared_accelbuf(const uint8_t * ptr, size_t nbytes) const;
+  // size class that a request of nbytes is rounded up to
+  static size_t size_class(size_t nbytes);
+  // bytes obtained from the platform
+  size_t bytes_reserved() const;
+  // bytes requested by buffers currently in use
+  size_t bytes_in_use() const;
+  // fraction of reserved bytes that are not used by any live buffer, either
+  // due to size class rounding or because they sit in a free list
+  float fragmentation() const;
+  // number of allocations served from a free list / from the platform
+  size_t num_reused() const;
+  size_t num_platform_allocs() const;
+
+protected:
+  // return the oldest free buffers to the platform until the free lists
+  // hold at most nbytes. call with m_lock held.
+  void trim(size_t nbytes);
+
+  // guards all members below, including platform allocations
+  mutable std::mutex m_lock;
+  WrapperRegDriver * m_platform;
+  // size class -> (free sequence number -> unused buffer of that class)
+  std::map<size_t, std::map<uint64_t, uint32_t>> m_free;
+  // free sequence number -> size class, oldest first
+  std::map<uint64_t, size_t> m_free_order;
+  uint64_t m_free_seq;
+  size_t m_bytes_free;
+  size_t m_max_free_bytes;
+  // live buffer -> (size class, requested bytes)
+  std::map<uint32_t, std::pair<size_t, size_t>> m_used;
+  // host address of buffers from alloc_shared() -> (accel address, bytes)
+  std::map<const uint8_t *, std::pair<uint32_t, size_t>> m_shared;
+  size_t m_bytes_reserved;
+  size_t m_bytes_in_use;
+  size_t m_num_reused;
+  size_t m_num_platform_allocs;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_ACCEL_POOL_HPP */
@@ -0,0 +1,272 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_completion.hpp"
+#include "bismo_rt_matmul.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+namespace bismo_rt {
+
+CompletionMonitor::CompletionMonitor() {
+  m_last_seq = 0;
+  m_dsc_base = 0;
+  m_dsc_issued = 0;
+  m_cc_last_retire = 0;
+  m_trace_last_retire = 0;
+  m_sample_valid = false;
+}
+
+uint64_t CompletionMonitor::submit(MatrixMultiply * mm) {
+  std::unique_lock<std::mutex> lock(m_lock);
+  // limit the number of outstanding descriptors to what the hardware can
+  // hold. an op with more descriptors than that is started on an idle
+  // accelerator and the rest is fed as the queue drains.
+  const size_t num_dsc = mm->num_descriptors();
+  while(!m_inflight.empty()) {
+    const uint32_t dsc_done = acc->res_dsccount() - m_dsc_base;
+    if(m_dsc_issued - dsc_done + num_dsc <= BISMORT_MAX_INFLIGHT_DSC) {
+      break;
+    }
+    const uint64_t seq = m_inflight.front().seq;
+    lock.unlock();
+    wait(seq);
+    lock.lock();
+  }
+  if(m_inflight.empty()) {
+    // pipeline is idle, (re)start it. the completed descriptor count keeps
+    // running across starts, so remember where it was.
+    acc->set_stage_enables(0, 0, 0);
+    if(instrgen_source == instrGenHost) {
+      acc->useDirectInstructionFeed();
+    } else {
+      acc->useDescriptors();
+    }
+    m_dsc_base = acc->res_dsccount();
+    m_dsc_issued = 0;
+    m_dsc_pending.clear();
+    m_ins_pending.clear();
+    m_cc_last_retire = 0;
+    // start the cycle counter (resets on enable) and all stages
+    acc->perf_set_cc_enable(1);
+    acc->set_stage_enables(1, 1, 1);
+    m_last_refresh = std::chrono::steady_clock::now();
+    m_sample_valid = false;
+  } else {
+    refresh_counters();
+  }
+  InflightOp op;
+  op.mm = mm;
+  op.seq = ++m_last_seq;
+  op.cc_start = acc->perf_get_cc();
+  op.trace_start = tracing() ? trace_now() : 0;
+  {
+    TraceScope t("dsc_push");
+    m_dsc_issued += mm->start(m_dsc_pending, m_ins_pending);
+    feed();
+  }
+  op.dsc_target = m_dsc_issued;
+  m_inflight.push_back(op);
+  return op.seq;
+}
+
+bool CompletionMonitor::busy() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return !m_inflight.empty();
+}
+
+void CompletionMonitor::feed() {
+  while(!m_dsc_pending.empty() && acc->dsc_ready()) {
+    acc->pushSingleMMDescriptor(m_dsc_pending.front());
+    m_dsc_pending.pop_front();
+  }
+  while(!m_ins_pending.empty() && acc->ins_ready()) {
+    acc->pushInstruction(m_ins_pending.front());
+    m_ins_pending.pop_front();
+  }
+}
+
+void CompletionMonitor::refresh_counters() {
+  if(us_since(m_last_refresh) >= 1000 * BISMORT_PERF_REFRESH_MS) {
+    // keep the 32-bit hardware counters from wrapping unnoticed
+    acc->perf_refresh();
+    m_last_refresh = std::chrono::steady_clock::now();
+  }
+}
+
+bool CompletionMonitor::update() {
+  if(m_inflight.empty()) {
+    return true;
+  }
+  feed();
+  refresh_counters();
+  const uint32_t dsc_done = acc->res_dsccount() - m_dsc_base;
+  while(!m_inflight.empty() && dsc_done >= m_inflight.front().dsc_target) {
+    const InflightOp & op = m_inflight.front();
+    // an op occupies the accelerator from when it was pushed or when the
+    // previous one finished, whichever is later
+    const uint64_t cc_now = acc->perf_get_cc();
+    const uint64_t cc_begin = std::max(op.cc_start, m_cc_last_retire);
+    op.mm->finish(cc_now - cc_begin);
+    m_cc_last_retire = cc_now;
+    if(tracing()) {
+      // shown on the accelerator track, same rules as for the cycles
+      const uint64_t t_now = trace_now();
+      const uint64_t t_begin = std::max(op.trace_start, m_trace_last_retire);
+      trace_complete("matmul", t_begin, t_now, BISMORT_TRACE_ACCEL_TID);
+      m_trace_last_retire = t_now;
+    }
+    m_inflight.pop_front();
+  }
+  if(tracing()) {
+    sample_stages();
+  }
+  if(m_inflight.empty()) {
+    // stop the cycle counter and all stages
+    acc->perf_set_cc_enable(0);
+    acc->set_stage_enables(0, 0, 0);
+  }
+  return m_inflight.empty();
+}
+
+void CompletionMonitor::sample_stages() {
+  static const char * const stage_names[3] = {"fetch", "exec", "result"};
+  const uint64_t t_now = trace_now();
+  if(m_sample_valid && t_now - m_sample_time < 1000 * BISMORT_TRACE_SAMPLE_US) {
+    return;
+  }
+  const uint64_t cc = acc->perf_get_cc();
+  const uint64_t run[3] = {
+    acc->perf_fetch_stats(csRun), acc->perf_exec_stats(csRun),
+    acc->perf_result_stats(csRun)
+  };
+  if(m_sample_valid && cc != m_sample_cc) {
+    float busy[3];
+    for(size_t i = 0; i < 3; i++) {
+      busy[i] = 100.0f * (run[i] - m_sample_run[i]) / (cc - m_sample_cc);
+    }
+    trace_counter("stage_busy_percent", stage_names, busy, 3);
+  }
+  m_sample_valid = true;
+  m_sample_time = t_now;
+  m_sample_cc = cc;
+  for(size_t i = 0; i < 3; i++) {
+    m_sample_run[i] = run[i];
+  }
+}
+
+bool CompletionMonitor::poll(uint64_t seq) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if(seq == 0 || seq > m_last_seq) {
+    throw "Invalid CompletionHandle";
+  }
+  // in-flight ops are retired in order, so anything older than the oldest
+  // in-flight op has already completed
+  if(m_inflight.empty() || seq < m_inflight.front().seq) {
+    return true;
+  }
+  update();
+  return m_inflight.empty() || seq < m_inflight.front().seq;
+}
+
+bool CompletionMonitor::wait(uint64_t seq, uint64_t timeout_us) {
+  if(poll(seq)) {
+    return true;
+  }
+  // only traced if there actually is something to wait for
+  TraceScope t("exec_wait");
+  auto t_start = std::chrono::steady_clock::now();
+  size_t iter = 0;
+  useconds_t sleep_us = 1;
+  while(!poll(seq)) {
+    if(timeout_us != 0) {
+      auto elapsed = std::chrono::steady_clock::now() - t_start;
+      if(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() >= (int64_t) timeout_us) {
+        return false;
+      }
+    }
+    // short layers finish within a few MMIO reads, so spin first. for longer
+    // ones, give the core back to other threads and back off exponentially
+    // to keep MMIO traffic and CPU usage low.
+    if(iter < BISMORT_POLL_SPIN_ITERS) {
+      iter++;
+    } else if(iter < BISMORT_POLL_SPIN_ITERS + BISMORT_POLL_YIELD_ITERS) {
+      iter++;
+      std::this_thread::yield();
+    } else {
+      usleep(sleep_us);
+      sleep_us = std::min(2 * sleep_us, (useconds_t) BISMORT_POLL_MAX_SLEEP_US);
+    }
+  }
+  return true;
+}
+
+void CompletionMonitor::drain() {
+  std::unique_lock<std::mutex> lock(m_lock);
+  if(!m_inflight.empty()) {
+    const uint64_t seq = m_inflight.back().seq;
+    lock.unlock();
+    wait(seq);
+  }
+}
+
+void CompletionMonitor::drain(MatrixMultiply * mm) {
+  std::unique_lock<std::mutex> lock(m_lock);
+  // wait for the most recent submission of mm, if any
+  for(auto it = m_inflight.rbegin(); it != m_inflight.rend(); ++it) {
+    if(it->mm == mm) {
+      const uint64_t seq = it->seq;
+      lock.unlock();
+      wait(seq);
+      return;
+    }
+  }
+}
+
+std::unique_lock<std::mutex> CompletionMonitor::lock() {
+  return std::unique_lock<std::mutex>(m_lock);
+}
+
+std::unique_lock<std::mutex> CompletionMonitor::lock_idle() {
+  std::unique_lock<std::mutex> lock(m_lock);
+  // other threads may submit more work while we wait
+  while(!m_inflight.empty()) {
+    const uint64_t seq = m_inflight.back().seq;
+    lock.unlock();
+    wait(seq);
+    lock.lock();
+  }
+  return lock;
+}
+
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_COMPLETION_HPP
+#define BISMORT_COMPLETION_HPP
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include "BISMOInstruction.hpp"
+
+namespace bismo_rt {
+
+class MatrixMultiply;
+
+// keeps track of matrix multiplies that have been started on the accelerator
+// and detects their completion, so that the host can do other work (e.g.
+// padding and p2s for the next request) while the accelerator is busy.
+// each submission gets a monotonically increasing sequence number, which is
+// what the public API hands out as a CompletionHandle.
+// matrix multiplies are queued back-to-back on the accelerator as long as no
+// more than BISMORT_MAX_INFLIGHT_DSC descriptors are outstanding; the
+// pipeline is only started when the first one is submitted and only stopped
+// once the last one has completed.
+// the monitor owns the accelerator: all accesses to the accelerator go
+// through it or hold the lock returned by lock_idle(). it is safe to call
+// from several threads, waiting does not hold the lock.
+class CompletionMonitor {
+public:
+  CompletionMonitor();
+  // queue given matrix multiply on the accelerator and return its sequence
+  // number. if its descriptors do not fit next to the ones already
+  // outstanding, this waits (without holding the lock) for the oldest
+  // matrix multiplies to complete first.
+  uint64_t submit(MatrixMultiply * mm);
+  // check (without blocking) whether given submission has completed
+  bool poll(uint64_t seq);
+  // block until given submission has completed or the timeout expires
+  // timeout_us = 0 means wait forever. returns true if completed.
+  bool wait(uint64_t seq, uint64_t timeout_us = 0);
+  // block until nothing is in flight anymore
+  void drain();
+  // block until given matrix multiply is not in flight anymore
+  void drain(MatrixMultiply * mm);
+  // block until nothing is in flight anymore and return with exclusive
+  // ownership of the accelerator, e.g. to run the p2s accelerator. nothing
+  // can be submitted until the returned lock is released.
+  std::unique_lock<std::mutex> lock_idle();
+  // lock the monitor without waiting for the accelerator, e.g. to read what
+  // finish() wrote into a matrix multiply
+  std::unique_lock<std::mutex> lock();
+  // whether the accelerator is currently executing something
+  bool busy() const;
+
+protected:
+  struct InflightOp {
+    MatrixMultiply * mm;
+    uint64_t seq;
+    // completed descriptor count (relative to m_dsc_base) that signals done
+    uint32_t dsc_target;
+    // cycle count when the descriptor was pushed
+    uint64_t cc_start;
+    // trace timestamp when the descriptor was pushed
+    uint64_t trace_start;
+  };
+  // push pending descriptors or instructions while the accelerator queue
+  // has room, never waits. call with m_lock held.
+  void feed();
+  // read the hardware counters if the last read was BISMORT_PERF_REFRESH_MS
+  // ago or longer, so that they cannot wrap unnoticed. call with m_lock held.
+  void refresh_counters();
+  // sample the hardware once and retire all in-flight ops that finished
+  // returns true if nothing is in flight after the update. call with m_lock
+  // held.
+  bool update();
+  // while tracing, sample the accelerator stage counters and record the
+  // fraction of cycles each stage spent running since the last sample.
+  // call with m_lock held.
+  void sample_stages();
+
+  // guards the accelerator and all members below
+  mutable std::mutex m_lock;
+  std::deque<InflightOp> m_inflight;
+  uint64_t m_last_seq;
+  // hardware completed descriptor count when the pipeline was started
+  uint32_t m_dsc_base;
+  // number of descriptors handed out since the pipeline was started,
+  // including the ones still in m_dsc_pending
+  uint32_t m_dsc_issued;
+  // descriptors (or host-generated instructions) of in-flight ops that did
+  // not fit into the accelerator queue yet, pushed by feed()
+  std::deque<SingleMMDescriptor> m_dsc_pending;
+  std::deque<BISMOInstruction> m_ins_pending;
+  // cycle count when the previous op was retired
+  uint64_t m_cc_last_retire;
+  // when the hardware counters were last read, see perf_refresh
+  std::chrono::steady_clock::time_point m_last_refresh;
+  // trace timestamp when the previous op was retired
+  uint64_t m_trace_last_retire;
+  // previous stage counter sample, see sample_stages
+  bool m_sample_valid;
+  uint64_t m_sample_time;
+  uint64_t m_sample_cc;
+  uint64_t m_sample_run[3];
+};
+
+}
+
+#endif /* end of include guard: BISMORT_COMPLETION_HPP */
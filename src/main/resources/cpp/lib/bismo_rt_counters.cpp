@@ -0,0 +1,173 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_counters.hpp"
+#include <string.h>
+#include <vector>
+#include <mutex>
+
+namespace bismo_rt {
+
+std::atomic<InstrumentationLevel> instr_level_setting(BISMORT_INSTRUMENTATION_LEVEL);
+thread_local LayerCounters * counters_layer = 0;
+
+// instrumentation key prefixes for each matrix group
+static const char * group_names[groupCount] = {
+  "mat_lhs", "mat_rhs", "mat_res", "mat_res_partial"
+};
+
+// key suffixes for each phase, and whether the phase is a time
+static const char * phase_names[phaseCount] = {
+  "pad", "host2accel", "p2s", "p2s_sw", "accel2host", "unpad"
+};
+static const bool phase_is_time[phaseCount] = {
+  true, true, true, false, true, true
+};
+
+// keys for the per-layer counters after the matrix ones
+static const char * layer_counter_names[ctrCount - ctrRunCycles] = {
+  "run_cycles", "e2e_latency"
+};
+static const bool layer_counter_is_time[ctrCount - ctrRunCycles] = {
+  false, true
+};
+
+// per-matrix phases for each group first, then the per-layer counters
+static_assert(groupCount == 4 && phaseCount == 6, "update counter_latency");
+const LatencyMetric counter_latency[ctrCount] = {
+  latPad, latHost2Accel, latP2S, latCount, latAccel2Host, latCount,
+  latPad, latHost2Accel, latP2S, latCount, latAccel2Host, latCount,
+  latPad, latHost2Accel, latP2S, latCount, latAccel2Host, latCount,
+  latPad, latHost2Accel, latP2S, latCount, latAccel2Host, latCount,
+  latAccelCycles, latEndToEnd
+};
+
+void setInstrumentationLevel(InstrumentationLevel level) {
+  instr_level_setting = level;
+}
+
+InstrumentationLevel getInstrumentationLevel() {
+  return instr_level();
+}
+
+CounterGroup counter_group(const std::string & name) {
+  for(size_t g = 0; g < groupCount; g++) {
+    if(name == group_names[g]) {
+      return (CounterGroup) g;
+    }
+  }
+  return groupNone;
+}
+
+const char * counter_name(size_t ctr) {
+  // built once, the trace keeps pointers to these
+  static std::vector<std::string> names;
+  static std::once_flag built;
+  std::call_once(built, [] {
+    for(size_t c = 0; c < ctrCount; c++) {
+      if(c < ctrRunCycles) {
+        names.push_back(std::string(group_names[c / phaseCount]) + "_" + phase_names[c % phaseCount]);
+      } else {
+        names.push_back(layer_counter_names[c - ctrRunCycles]);
+      }
+    }
+  });
+  return names[ctr].c_str();
+}
+
+LayerCounters::LayerCounters() {
+  reset();
+}
+
+void LayerCounters::reset() {
+  memset(m_last, 0, sizeof(m_last));
+  memset(m_total, 0, sizeof(m_total));
+  memset(m_calls, 0, sizeof(m_calls));
+  reset_latency_stats();
+}
+
+void LayerCounters::reset_latency_stats() {
+  for(size_t m = 0; m < latCount; m++) {
+    m_hist[m].reset();
+  }
+}
+
+LatencyStats LayerCounters::latency_stats() const {
+  LatencyStats ret;
+  for(size_t m = 0; m < latCount; m++) {
+    // times are recorded in nanoseconds and reported in microseconds
+    const float scale = (m == latAccelCycles) ? 1.0f : 1e-3f;
+    const LatencyHistogram & h = m_hist[m];
+    ret.metric[m].count = h.count();
+    ret.metric[m].p50 = scale * h.quantile(0.50);
+    ret.metric[m].p90 = scale * h.quantile(0.90);
+    ret.metric[m].p99 = scale * h.quantile(0.99);
+    ret.metric[m].max = scale * h.max();
+  }
+  return ret;
+}
+
+uint64_t LayerCounters::last(size_t ctr) const {
+  return m_last[ctr];
+}
+
+uint64_t LayerCounters::total(size_t ctr) const {
+  return m_total[ctr];
+}
+
+uint64_t LayerCounters::calls(size_t ctr) const {
+  return m_calls[ctr];
+}
+
+void LayerCounters::export_to(InstrumentationData & data, bool detailed) const {
+  for(size_t ctr = 0; ctr < ctrCount; ctr++) {
+    if(m_calls[ctr] == 0) {
+      continue;
+    }
+    const std::string key = counter_name(ctr);
+    bool is_time;
+    if(ctr < ctrRunCycles) {
+      is_time = phase_is_time[ctr % phaseCount];
+    } else {
+      is_time = layer_counter_is_time[ctr - ctrRunCycles];
+    }
+    // times are reported in microseconds
+    const float scale = is_time ? 1e-3f : 1.0f;
+    const std::string unit = is_time ? "_us" : "";
+    data[key + unit] = scale * m_last[ctr];
+    if(detailed) {
+      data[key + "_total" + unit] = scale * m_total[ctr];
+      data[key + "_calls"] = m_calls[ctr];
+    }
+  }
+}
+
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_COUNTERS_HPP
+#define BISMORT_COUNTERS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include "bismo_rt.hpp"
+#include "bismo_rt_options.hpp"
+#include "bismo_rt_histogram.hpp"
+#include "bismo_rt_trace.hpp"
+
+namespace bismo_rt {
+
+// host-side phases recorded for each matrix
+typedef enum {
+  phasePad, phaseHost2Accel, phaseP2S, phaseP2SSW, phaseAccel2Host, phaseUnpad,
+  phaseCount
+} MatrixPhase;
+
+// matrices of a layer that have their own counters
+typedef enum {
+  groupLHS, groupRHS, groupRes, groupResPartial, groupCount,
+  groupNone = groupCount
+} CounterGroup;
+
+// fixed counter slots, one per matrix group and phase, followed by the
+// per-layer ones
+typedef enum {
+  ctrRunCycles = groupCount * phaseCount,
+  ctrEndToEnd,
+  ctrCount
+} Counter;
+
+// latency histogram each counter feeds into, latCount if none
+extern const LatencyMetric counter_latency[ctrCount];
+
+// counter slot for given matrix group and phase, ctrCount if none
+inline size_t matrix_counter(CounterGroup group, MatrixPhase phase) {
+  return (group == groupNone) ? ctrCount : group * phaseCount + phase;
+}
+
+// counter group for a matrix name as used in the instrumentation keys
+CounterGroup counter_group(const std::string & name);
+// name of a counter without unit, e.g. mat_lhs_pad
+const char * counter_name(size_t ctr);
+
+// instrumentation counters of one layer. recording is a few stores into
+// fixed slots plus a histogram bucket increment, the string-keyed
+// InstrumentationData is only built on request. times are recorded in
+// nanoseconds.
+class LayerCounters {
+public:
+  LayerCounters();
+  void reset();
+  void record(size_t ctr, uint64_t value) {
+    m_last[ctr] = value;
+    m_total[ctr] += value;
+    m_calls[ctr]++;
+    if(counter_latency[ctr] != latCount) {
+      m_hist[counter_latency[ctr]].record(value);
+    }
+  };
+  // summarize the latency histograms
+  LatencyStats latency_stats() const;
+  void reset_latency_stats();
+  uint64_t last(size_t ctr) const;
+  uint64_t total(size_t ctr) const;
+  uint64_t calls(size_t ctr) const;
+  // add the most recent value of each recorded counter to data, and also
+  // the totals and number of calls if detailed
+  void export_to(InstrumentationData & data, bool detailed) const;
+
+protected:
+  uint64_t m_last[ctrCount];
+  uint64_t m_total[ctrCount];
+  uint64_t m_calls[ctrCount];
+  LatencyHistogram m_hist[latCount];
+};
+
+extern std::atomic<InstrumentationLevel> instr_level_setting;
+// counters of the layer the calling thread is currently working on
+extern thread_local LayerCounters * counters_layer;
+
+inline InstrumentationLevel instr_level() {
+#ifdef BISMORT_INSTRUMENTATION
+  return instr_level_setting.load(std::memory_order_relaxed);
+#else
+  return instrOff;
+#endif
+}
+
+// record a value into a counter of the current layer, if any
+inline void record_counter(size_t ctr, uint64_t value) {
+  if(counters_layer && ctr < ctrCount && instr_level() != instrOff) {
+    counters_layer->record(ctr, value);
+  }
+}
+
+// measures the time until stop() is called or it goes out of scope and
+// records it into a counter of the current layer, and into the trace if
+// tracing. does nothing if instrumentation is off or there is no current
+// layer, and tracing is off.
+class PhaseTimer {
+public:
+  PhaseTimer(size_t ctr) {
+    m_ctr = ctr;
+    m_on = counters_layer && ctr < ctrCount && instr_level() != instrOff;
+    m_trace = ctr < ctrCount && tracing();
+    if(m_on || m_trace) {
+      m_start = std::chrono::steady_clock::now();
+    }
+  };
+  ~PhaseTimer() {
+    stop();
+  };
+  void stop() {
+    if(m_on || m_trace) {
+      const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      if(m_on) {
+        const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          end - m_start
+        ).count();
+        counters_layer->record(m_ctr, ns);
+      }
+      if(m_trace) {
+        trace_complete(counter_name(m_ctr), trace_time(m_start), trace_time(end), trace_tid());
+      }
+      m_on = false;
+      m_trace = false;
+    }
+  };
+protected:
+  size_t m_ctr;
+  bool m_on;
+  bool m_trace;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+// records the instrumentation of the calling thread into given counters
+// while in scope
+class InstrumentationScope {
+public:
+  InstrumentationScope(LayerCounters & target) {
+    m_prev = counters_layer;
+    counters_layer = &target;
+  };
+  ~InstrumentationScope() {
+    counters_layer = m_prev;
+  };
+protected:
+  LayerCounters * m_prev;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_COUNTERS_HPP */
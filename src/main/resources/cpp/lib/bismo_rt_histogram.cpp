@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_histogram.hpp"
+#include <string.h>
+#include <math.h>
+
+namespace bismo_rt {
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+void LatencyHistogram::reset() {
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_count = 0;
+  m_max = 0;
+}
+
+size_t LatencyHistogram::bucket(uint64_t value) {
+  if(value < s_sub) {
+    return value;
+  }
+  // position of the leading one, then the next s_sub_bits bits below it
+  const size_t msb = 63 - __builtin_clzll(value);
+  const size_t sub = (value >> (msb - s_sub_bits)) & (s_sub - 1);
+  return (msb - s_sub_bits + 1) * s_sub + sub;
+}
+
+uint64_t LatencyHistogram::bucket_start(size_t b) {
+  if(b < s_sub) {
+    return b;
+  }
+  const size_t msb = b / s_sub + s_sub_bits - 1;
+  return (uint64_t)(s_sub + b % s_sub) << (msb - s_sub_bits);
+}
+
+uint64_t LatencyHistogram::bucket_width(size_t b) {
+  if(b < s_sub) {
+    return 1;
+  }
+  const size_t msb = b / s_sub + s_sub_bits - 1;
+  return (uint64_t) 1 << (msb - s_sub_bits);
+}
+
+uint64_t LatencyHistogram::count() const {
+  return m_count;
+}
+
+uint64_t LatencyHistogram::max() const {
+  return m_max;
+}
+
+uint64_t LatencyHistogram::quantile(float q) const {
+  if(m_count == 0) {
+    return 0;
+  }
+  // rank of the requested value among the recorded ones, 1-based
+  uint64_t rank = (uint64_t) ceil(q * m_count);
+  rank = (rank < 1) ? 1 : rank;
+  uint64_t seen = 0;
+  for(size_t b = 0; b < s_nbuckets; b++) {
+    seen += m_buckets[b];
+    if(seen >= rank) {
+      const uint64_t mid = bucket_start(b) + bucket_width(b) / 2;
+      // never report more than what was actually seen
+      return (mid < m_max) ? mid : m_max;
+    }
+  }
+  return m_max;
+}
+
+}
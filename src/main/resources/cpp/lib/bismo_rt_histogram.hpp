@@ -0,0 +1,77 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_HISTOGRAM_HPP
+#define BISMORT_HISTOGRAM_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace bismo_rt {
+
+// histogram of non-negative values with logarithmic buckets: values below 16
+// are counted exactly, larger ones in 16 linear sub-buckets per power of two.
+// quantiles are accurate to within 1/16 of the value, with a fixed memory
+// footprint regardless of the range of values.
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+  void reset();
+  void record(uint64_t value) {
+    m_buckets[bucket(value)]++;
+    m_count++;
+    if(value > m_max) {
+      m_max = value;
+    }
+  };
+  uint64_t count() const;
+  uint64_t max() const;
+  // value below which a fraction q (0..1) of the recorded values fall,
+  // reported as the middle of the containing bucket
+  uint64_t quantile(float q) const;
+
+protected:
+  static size_t bucket(uint64_t value);
+  // smallest value and width of given bucket
+  static uint64_t bucket_start(size_t b);
+  static uint64_t bucket_width(size_t b);
+
+  static const size_t s_sub_bits = 4;
+  static const size_t s_sub = 1 << s_sub_bits;
+  static const size_t s_nbuckets = (64 - s_sub_bits + 1) * s_sub;
+  uint32_t m_buckets[s_nbuckets];
+  uint64_t m_count;
+  uint64_t m_max;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_HISTOGRAM_HPP */
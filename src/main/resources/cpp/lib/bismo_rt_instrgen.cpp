@@ -0,0 +1,436 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_instrgen.hpp"
+
+namespace bismo_rt {
+
+const char * RHSLHSTiling::name() const {
+  return "rhs_lhs";
+}
+
+void RHSLHSTiling::schedule(
+  const SingleMMDescriptor & dsc, std::vector<TileStep> & steps
+) const {
+  for(uint16_t n = 0; n < dsc.tiles_n; n++) {
+    for(uint16_t m = 0; m < dsc.tiles_m; m++) {
+      TileStep step;
+      step.m = m;
+      step.n = n;
+      step.fetch_lhs = true;
+      step.release_lhs = true;
+      step.fetch_rhs = (m == 0);
+      step.release_rhs = (m == dsc.tiles_m - 1);
+      steps.push_back(step);
+    }
+  }
+}
+
+const char * LHSRHSTiling::name() const {
+  return "lhs_rhs";
+}
+
+void LHSRHSTiling::schedule(
+  const SingleMMDescriptor & dsc, std::vector<TileStep> & steps
+) const {
+  for(uint16_t m = 0; m < dsc.tiles_m; m++) {
+    for(uint16_t n = 0; n < dsc.tiles_n; n++) {
+      TileStep step;
+      step.m = m;
+      step.n = n;
+      step.fetch_lhs = (n == 0);
+      step.release_lhs = (n == dsc.tiles_n - 1);
+      step.fetch_rhs = true;
+      step.release_rhs = true;
+      steps.push_back(step);
+    }
+  }
+}
+
+const char * LHSResidentTiling::name() const {
+  return "lhs_resident";
+}
+
+void LHSResidentTiling::schedule(
+  const SingleMMDescriptor & dsc, std::vector<TileStep> & steps
+) const {
+  for(uint16_t n = 0; n < dsc.tiles_n; n++) {
+    for(uint16_t m = 0; m < dsc.tiles_m; m++) {
+      TileStep step;
+      step.m = m;
+      step.n = n;
+      step.fetch_lhs = (m == 0 && n == 0);
+      step.release_lhs = (m == dsc.tiles_m - 1 && n == dsc.tiles_n - 1);
+      step.fetch_rhs = (m == 0);
+      step.release_rhs = (m == dsc.tiles_m - 1);
+      steps.push_back(step);
+    }
+  }
+}
+
+bool LHSResidentTiling::lhs_resident(const SingleMMDescriptor & dsc) const {
+  return true;
+}
+
+static const RHSLHSTiling rhs_lhs_tiling;
+static const LHSRHSTiling lhs_rhs_tiling;
+static const LHSResidentTiling lhs_resident_tiling;
+
+const char * DescriptorTiling::name() const {
+  return "descriptor";
+}
+
+void DescriptorTiling::schedule(
+  const SingleMMDescriptor & dsc, std::vector<TileStep> & steps
+) const {
+  if(dsc.tiling == tilingLHSRHS) {
+    lhs_rhs_tiling.schedule(dsc, steps);
+  } else if(dsc.tiling == tilingLHSResident) {
+    lhs_resident_tiling.schedule(dsc, steps);
+  } else {
+    rhs_lhs_tiling.schedule(dsc, steps);
+  }
+}
+
+bool DescriptorTiling::lhs_resident(const SingleMMDescriptor & dsc) const {
+  return dsc.tiling == tilingLHSResident;
+}
+
+void InstrStreams::clear() {
+  fetch.clear();
+  exec.clear();
+  result.clear();
+}
+
+size_t InstrStreams::size() const {
+  return fetch.size() + exec.size() + result.size();
+}
+
+static const DescriptorTiling default_tiling;
+
+InstrGen::InstrGen(const HardwareCfg & cfg, const TilingPolicy * policy) {
+  m_cfg = cfg;
+  set_policy(policy);
+  m_etf_s = 0;
+  while((m_cfg.readChanWidth << m_etf_s) < m_cfg.dpaDimCommon) {
+    m_etf_s++;
+  }
+  reset();
+}
+
+void InstrGen::reset() {
+  m_lmem_region = 0;
+  m_rmem_region = 0;
+  m_offset_res = 0;
+}
+
+void InstrGen::set_policy(const TilingPolicy * policy) {
+  m_policy = policy ? policy : &default_tiling;
+}
+
+const TilingPolicy * InstrGen::policy() const {
+  return m_policy;
+}
+
+void InstrGen::generate(const SingleMMDescriptor & dsc, InstrStreams & out) {
+  std::vector<TileStep> steps;
+  m_policy->schedule(dsc, steps);
+  // exec must release the tiles in the order fetch filled the regions, and
+  // leave nothing behind for the next descriptor
+  int live_lhs = 0, live_rhs = 0;
+  for(auto & step : steps) {
+    live_lhs += step.fetch_lhs ? 1 : 0;
+    live_rhs += step.fetch_rhs ? 1 : 0;
+    if(live_lhs != 1 || live_rhs != 1) {
+      throw "InstrGen: tiling policy must keep one LHS and one RHS tile";
+    }
+    live_lhs -= step.release_lhs ? 1 : 0;
+    live_rhs -= step.release_rhs ? 1 : 0;
+  }
+  if(live_lhs != 0 || live_rhs != 0) {
+    throw "InstrGen: tiling policy does not release all tiles";
+  }
+  // the fetch and exec stages go through the same buffer regions, and the
+  // exec and result stages through the same result buffers
+  const uint8_t lmem_region = m_lmem_region;
+  const uint8_t rmem_region = m_rmem_region;
+  const uint8_t offset_res = m_offset_res;
+  gen_exec(dsc, steps, out.exec);
+  m_lmem_region = lmem_region;
+  m_rmem_region = rmem_region;
+  gen_fetch(dsc, steps, out.fetch);
+  m_offset_res = offset_res;
+  gen_result(dsc, steps, out.result);
+}
+
+// a buffer region index in the range of a descriptor, see FetchInstrGen.cpp
+static uint8_t region_start(uint8_t region, const SingleMMDescriptor & dsc) {
+  return (region >= (1 << dsc.nbufs_fetch_exec_log2)) ? 0 : region;
+}
+
+static BISMOInstruction sync_instr(
+  BISMOTargetStage stage, bool send, uint8_t chan
+) {
+  BISMOSyncInstruction sync;
+  sync.targetStage = stage;
+  sync.isRunCfg = 0;
+  sync.isSendToken = send ? 1 : 0;
+  sync.chanID = chan;
+  return sync.asRaw();
+}
+
+void InstrGen::gen_fetch(
+  const SingleMMDescriptor & dsc, const std::vector<TileStep> & steps,
+  std::vector<BISMOInstruction> & out
+) {
+  const uint8_t num_regions = (1 << dsc.nbufs_fetch_exec_log2);
+  const uint16_t lmem_region_size = (m_cfg.lhsEntriesPerMem >> dsc.nbufs_fetch_exec_log2);
+  const uint16_t rmem_region_size = (m_cfg.rhsEntriesPerMem >> dsc.nbufs_fetch_exec_log2);
+  uint8_t lmem_region = region_start(m_lmem_region, dsc);
+  uint8_t rmem_region = region_start(m_rmem_region, dsc);
+  const int bytes_per_lhs_tile = (m_cfg.dpaDimLHS * m_cfg.dpaDimCommon) / 8;
+  const int bytes_per_rhs_tile = (m_cfg.dpaDimRHS * m_cfg.dpaDimCommon) / 8;
+  // a resident LHS is fetched tile by tile into consecutive entries
+  const bool lhs_resident = m_policy->lhs_resident(dsc);
+  const uint16_t lhs_tile_entries = dsc.bits_l * dsc.tiles_k;
+  const uint16_t lhs_tiles_per_fetch = lhs_resident ? dsc.tiles_m : 1;
+  BISMOFetchRunInstruction fetch;
+  fetch.targetStage = stgFetch;
+  fetch.isRunCfg = 1;
+  // DRAM words copied before the fetch interconnect moves to the next BRAM
+  fetch.tiles_per_row = dsc.tiles_k << m_etf_s;
+  for(auto & step : steps) {
+    if(step.fetch_rhs) {
+      // wait for a free buffer region, fill it with all bit positions of the
+      // RHS tile (one block each) and hand it to the exec stage
+      out.push_back(sync_instr(stgFetch, false, 0));
+      const uint16_t rmem_region_offset = rmem_region * rmem_region_size;
+      fetch.dram_block_count = dsc.bits_r;
+      fetch.dram_block_size_bytes = dsc.tiles_k * bytes_per_rhs_tile;
+      fetch.dram_block_offset_bytes = dsc.tiles_n * dsc.tiles_k * bytes_per_rhs_tile;
+      fetch.dram_base = dsc.dram_rhs + step.n * dsc.tiles_k * bytes_per_rhs_tile;
+      fetch.bram_addr_base = (dsc.base_r + rmem_region_offset) << m_etf_s;
+      fetch.bram_id_start = m_cfg.dpaDimLHS;
+      fetch.bram_id_range = 1;
+      out.push_back(fetch.asRaw());
+      out.push_back(sync_instr(stgFetch, true, 0));
+      rmem_region = (rmem_region + 1) % num_regions;
+    }
+    if(step.fetch_lhs) {
+      out.push_back(sync_instr(stgFetch, false, 0));
+      const uint16_t lmem_region_offset = lmem_region * lmem_region_size;
+      fetch.dram_block_count = dsc.bits_l;
+      fetch.dram_block_size_bytes = dsc.tiles_k * bytes_per_lhs_tile;
+      fetch.dram_block_offset_bytes = dsc.tiles_m * dsc.tiles_k * bytes_per_lhs_tile;
+      fetch.bram_id_start = 0;
+      fetch.bram_id_range = 0;
+      for(uint16_t t = 0; t < lhs_tiles_per_fetch; t++) {
+        const uint16_t lhs_tile = lhs_resident ? t : step.m;
+        fetch.dram_base = dsc.dram_lhs + lhs_tile * dsc.tiles_k * bytes_per_lhs_tile;
+        fetch.bram_addr_base = (dsc.base_l + lmem_region_offset + t * lhs_tile_entries) << m_etf_s;
+        out.push_back(fetch.asRaw());
+      }
+      out.push_back(sync_instr(stgFetch, true, 0));
+      lmem_region = (lmem_region + 1) % num_regions;
+    }
+  }
+  m_lmem_region = lmem_region;
+  m_rmem_region = rmem_region;
+}
+
+void InstrGen::gen_exec(
+  const SingleMMDescriptor & dsc, const std::vector<TileStep> & steps,
+  std::vector<BISMOInstruction> & out
+) {
+  const uint8_t num_regions = (1 << dsc.nbufs_fetch_exec_log2);
+  const uint16_t lmem_region_size = (m_cfg.lhsEntriesPerMem >> dsc.nbufs_fetch_exec_log2);
+  const uint16_t rmem_region_size = (m_cfg.rhsEntriesPerMem >> dsc.nbufs_fetch_exec_log2);
+  uint8_t lmem_region = region_start(m_lmem_region, dsc);
+  uint8_t rmem_region = region_start(m_rmem_region, dsc);
+  const int nslices = dsc.bits_l + dsc.bits_r - 1;
+  const bool lhs_resident = m_policy->lhs_resident(dsc);
+  const uint16_t lhs_tile_entries = dsc.bits_l * dsc.tiles_k;
+  BISMOExecRunInstruction exec;
+  exec.targetStage = stgExec;
+  exec.isRunCfg = 1;
+  exec.numTiles = dsc.tiles_k;
+  for(auto & step : steps) {
+    // wait for the input tiles that are fetched for this step, then acquire
+    // a result buffer unless the results stay in the accumulators
+    if(step.fetch_rhs) {
+      out.push_back(sync_instr(stgExec, false, 0));
+    }
+    if(step.fetch_lhs) {
+      out.push_back(sync_instr(stgExec, false, 0));
+    }
+    if(!dsc.defer_writeback) {
+      out.push_back(sync_instr(stgExec, false, 1));
+    }
+    const uint16_t lmem_region_offset = lmem_region * lmem_region_size;
+    const uint16_t rmem_region_offset = rmem_region * rmem_region_size;
+    // one instruction per pair of bit positions, in order of increasing
+    // significance (slice = sum of the bit weights from the top) so that
+    // the accumulator can be shifted left by one between slices
+    for(int slice = 0; slice < nslices; slice++) {
+      const int z1 = slice < dsc.bits_r ? 0 : (slice - dsc.bits_r + 1);
+      const int z2 = slice < dsc.bits_l ? 0 : (slice - dsc.bits_l + 1);
+      for(int j = slice - z2; j >= z1; j--) {
+        const int l = dsc.bits_l - j - 1;
+        const int r = dsc.bits_r - (slice - j) - 1;
+        const bool neg_l = (l == dsc.bits_l - 1) && dsc.signed_l;
+        const bool neg_r = (r == dsc.bits_r - 1) && dsc.signed_r;
+        const uint16_t offset_l = (lhs_resident ? step.m * lhs_tile_entries : 0) + dsc.tiles_k * l;
+        const uint16_t offset_r = dsc.tiles_k * r;
+        exec.lhsOffset = (dsc.base_l + lmem_region_offset + offset_l) << m_etf_s;
+        exec.rhsOffset = (dsc.base_r + rmem_region_offset + offset_r) << m_etf_s;
+        // a descriptor that accumulates onto the previous one starts
+        // without clearing or shifting the partial sums
+        const bool cont = (slice == 0) && dsc.accumulate;
+        exec.shiftAmount = (j == slice - z2 && !cont) ? 1 : 0;
+        exec.negate = (neg_l ^ neg_r) ? 1 : 0;
+        exec.clear_before_first_accumulation = (slice == 0 && !cont) ? 1 : 0;
+        exec.writeEn = (slice == nslices - 1 && !dsc.defer_writeback) ? 1 : 0;
+        exec.writeAddr = dsc.base_res + m_offset_res;
+        out.push_back(exec.asRaw());
+      }
+    }
+    // hand the result buffer to the result stage and release the inputs
+    if(!dsc.defer_writeback) {
+      out.push_back(sync_instr(stgExec, true, 1));
+      m_offset_res = (m_offset_res + 1) % m_cfg.resEntriesPerMem;
+    }
+    if(step.release_lhs) {
+      out.push_back(sync_instr(stgExec, true, 0));
+      lmem_region = (lmem_region + 1) % num_regions;
+    }
+    if(step.release_rhs) {
+      out.push_back(sync_instr(stgExec, true, 0));
+      rmem_region = (rmem_region + 1) % num_regions;
+    }
+  }
+  m_lmem_region = lmem_region;
+  m_rmem_region = rmem_region;
+}
+
+void InstrGen::gen_result(
+  const SingleMMDescriptor & dsc, const std::vector<TileStep> & steps,
+  std::vector<BISMOInstruction> & out
+) {
+  const size_t bytes_per_acc = m_cfg.accWidth / 8;
+  // results are written column by column with a stride of the LHS rows
+  const size_t lhs_nrows_a = dsc.tiles_m * m_cfg.dpaDimLHS;
+  BISMOResultRunInstruction res;
+  res.targetStage = stgResult;
+  res.isRunCfg = 1;
+  res.dram_skip = bytes_per_acc * lhs_nrows_a;
+  for(auto & step : steps) {
+    // nothing to write if the results stay in the exec stage accumulators
+    if(dsc.defer_writeback) {
+      break;
+    }
+    // wait for exec to fill a result buffer, write it out and free it
+    out.push_back(sync_instr(stgResult, false, 0));
+    const size_t ind = (m_cfg.dpaDimRHS * step.n) * lhs_nrows_a + m_cfg.dpaDimLHS * step.m;
+    res.dram_base = dsc.dram_res + ind * bytes_per_acc;
+    res.resmem_addr = m_offset_res;
+    out.push_back(res.asRaw());
+    m_offset_res = (m_offset_res + 1) % m_cfg.resEntriesPerMem;
+    out.push_back(sync_instr(stgResult, true, 0));
+  }
+  // wait for all writes to complete, this also makes the descriptor count
+  // in res_dsccount
+  res.nop = 1;
+  res.waitCompleteBytes = 1;
+  res.dram_base = 0;
+  res.dram_skip = 0;
+  res.resmem_addr = 0;
+  out.push_back(res.asRaw());
+}
+
+void InstrGen::interleave(
+  const InstrStreams & in, std::vector<BISMOInstruction> & out,
+  size_t execres_tokens
+) {
+  // token queues between the stages, with the tokens they start out with
+  // (see BitSerialMatMulAccelDriver::init_resource_pools)
+  enum { qExecFetch, qFetchExec, qResExec, qExecRes, qCount };
+  int tokens[qCount] = {FETCHEXEC_TOKENS, 0, (int) execres_tokens, 0};
+  // queue used by a sync instruction, indexed by stage, send and channel
+  static const int sync_queue[3][2][2] = {
+    {{qExecFetch, -1}, {qFetchExec, -1}},
+    {{qFetchExec, qResExec}, {qExecFetch, qExecRes}},
+    {{qExecRes, -1}, {qResExec, -1}}
+  };
+  const std::vector<BISMOInstruction> * stage_ins[3] = {
+    &in.fetch, &in.exec, &in.result
+  };
+  size_t pos[3] = {0, 0, 0};
+  size_t remaining = in.size();
+  out.reserve(out.size() + remaining);
+  while(remaining > 0) {
+    size_t taken = 0;
+    for(size_t s = 0; s < 3; s++) {
+      // take instructions from this stage until it has to wait for a token
+      // or has been given one to run, which keeps the stage queues short
+      const std::vector<BISMOInstruction> & ins = *stage_ins[s];
+      while(pos[s] < ins.size()) {
+        BISMOSyncInstruction sync;
+        sync.fromRaw(ins[pos[s]]);
+        const bool is_run = (sync.isRunCfg == 1);
+        if(!is_run) {
+          const int q = sync_queue[s][(int)sync.isSendToken][(int)sync.chanID];
+          if(q < 0) {
+            throw "InstrGen: sync instruction on an unused channel";
+          }
+          if(sync.isSendToken) {
+            tokens[q]++;
+          } else if(tokens[q] > 0) {
+            tokens[q]--;
+          } else {
+            break;
+          }
+        }
+        out.push_back(ins[pos[s]]);
+        pos[s]++;
+        taken++;
+        if(is_run) {
+          break;
+        }
+      }
+    }
+    if(taken == 0) {
+      throw "InstrGen: instruction streams would deadlock";
+    }
+    remaining -= taken;
+  }
+}
+
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_INSTRGEN_HPP
+#define BISMORT_INSTRGEN_HPP
+
+#include <stdint.h>
+#include <vector>
+#include "BitSerialMatMulAccelDriver.hpp"
+
+namespace bismo_rt {
+
+// one step of a tiling schedule: compute result tile (m, n) of a descriptor.
+// if fetch_lhs / fetch_rhs is set, the LHS / RHS tile is fetched into the
+// next buffer region before the step, otherwise the tile fetched last is
+// reused. release_lhs / release_rhs hands the region back to the fetch stage
+// after the step. each fetched tile must be released exactly once.
+struct TileStep {
+  uint16_t m, n;
+  bool fetch_lhs, fetch_rhs;
+  bool release_lhs, release_rhs;
+};
+
+// decides in which order the result tiles of a descriptor are computed and
+// which input tiles stay in the on-chip buffers between them
+class TilingPolicy {
+public:
+  virtual ~TilingPolicy() {};
+  virtual const char * name() const = 0;
+  virtual void schedule(
+    const SingleMMDescriptor & dsc, std::vector<TileStep> & steps
+  ) const = 0;
+  // whether the fetch_lhs of the first step fetches all LHS tiles into a
+  // single buffer region, one after the other, to be released by the last
+  // step. the LHS must then fit into a region.
+  virtual bool lhs_resident(const SingleMMDescriptor & dsc) const {
+    return false;
+  }
+};
+
+// RHS-stationary: fetch each RHS tile once and stream all LHS tiles past it
+class RHSLHSTiling : public TilingPolicy {
+public:
+  const char * name() const;
+  void schedule(const SingleMMDescriptor & dsc, std::vector<TileStep> & steps) const;
+};
+
+// LHS-stationary: fetch each LHS tile once and stream all RHS tiles past it
+class LHSRHSTiling : public TilingPolicy {
+public:
+  const char * name() const;
+  void schedule(const SingleMMDescriptor & dsc, std::vector<TileStep> & steps) const;
+};
+
+// RHS-stationary, with the entire LHS fetched once for all RHS tiles
+class LHSResidentTiling : public TilingPolicy {
+public:
+  const char * name() const;
+  void schedule(const SingleMMDescriptor & dsc, std::vector<TileStep> & steps) const;
+  bool lhs_resident(const SingleMMDescriptor & dsc) const;
+};
+
+// the schedule of the HLS instruction generators, one of the above as
+// chosen by the tiling field of the descriptor
+class DescriptorTiling : public TilingPolicy {
+public:
+  const char * name() const;
+  void schedule(const SingleMMDescriptor & dsc, std::vector<TileStep> & steps) const;
+  bool lhs_resident(const SingleMMDescriptor & dsc) const;
+};
+
+// instructions for each of the accelerator stages
+struct InstrStreams {
+  std::vector<BISMOInstruction> fetch, exec, result;
+  void clear();
+  size_t size() const;
+};
+
+// host-side counterpart of the instruction generators in the bitfile (see
+// src/main/resources/hls), produces the same instructions for the default
+// policy. like those, it carries the buffer regions and the result buffer in
+// use over to the next descriptor, so descriptors must be generated in the
+// order they are executed and after a reset of the accelerator, reset() must
+// be called.
+class InstrGen {
+public:
+  // policy = 0 uses DescriptorTiling, the policy must outlive the InstrGen
+  InstrGen(const HardwareCfg & cfg, const TilingPolicy * policy = 0);
+  // go back to the state after an accelerator reset
+  void reset();
+  void set_policy(const TilingPolicy * policy);
+  const TilingPolicy * policy() const;
+  // append the instructions for given descriptor to out
+  void generate(const SingleMMDescriptor & dsc, InstrStreams & out);
+  // merge the instructions of all stages into a single stream for the direct
+  // instruction feed. the hardware blocks a stage waiting for a token until
+  // it arrives, so every token must be sent earlier in the stream than it is
+  // received. throws if the streams can not be ordered like that.
+  // execres_tokens is the number of result buffers the driver gave tokens
+  // for, see BitSerialMatMulAccelDriver::init_resource_pools.
+  static void interleave(
+    const InstrStreams & in, std::vector<BISMOInstruction> & out,
+    size_t execres_tokens
+  );
+
+protected:
+  void gen_fetch(
+    const SingleMMDescriptor & dsc, const std::vector<TileStep> & steps,
+    std::vector<BISMOInstruction> & out
+  );
+  void gen_exec(
+    const SingleMMDescriptor & dsc, const std::vector<TileStep> & steps,
+    std::vector<BISMOInstruction> & out
+  );
+  void gen_result(
+    const SingleMMDescriptor & dsc, const std::vector<TileStep> & steps,
+    std::vector<BISMOInstruction> & out
+  );
+
+  HardwareCfg m_cfg;
+  const TilingPolicy * m_policy;
+  // exec-to-fetch left-shift ratio: log2(dpaDimCommon / readChanWidth)
+  size_t m_etf_s;
+  // buffer regions and result buffer to use next, kept across descriptors
+  uint8_t m_lmem_region, m_rmem_region, m_offset_res;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_INSTRGEN_HPP */
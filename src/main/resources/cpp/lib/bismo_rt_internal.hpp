@@ -37,8 +37,16 @@
 #include <string.h>
 #include <algorithm>
 #include <chrono>
+#include <mutex>
 
 #include "bismo_rt_options.hpp"
+#include "bismo_rt_completion.hpp"
+#include "bismo_rt_accel_pool.hpp"
+#include "bismo_rt_plan_cache.hpp"
+#include "bismo_rt_staging.hpp"
+#include "bismo_rt_counters.hpp"
+#include "bismo_rt_trace.hpp"
+#include "bismo_rt_instrgen.hpp"
 
 #ifdef DEBUG
 #define BISMORT_DEBUG(x) cout << x << endl;
@@ -51,7 +59,7 @@
 #define TIMER_SAMPLE() ;
 #define TIMER_REPORT(name) ;
 #else
-#define TIMER_INIT() std::chrono::time_point<std::chrono::high_resolution_clock> time_prev = std::chrono::high_resolution_clock::now(); std::chrono::time_point<std::chrono::high_resolution_clock> time_now = std::chrono::high_resolution_clock::now();
+#define TIMER_INIT() thread_local std::chrono::time_point<std::chrono::high_resolution_clock> time_prev = std::chrono::high_resolution_clock::now(); thread_local std::chrono::time_point<std::chrono::high_resolution_clock> time_now = std::chrono::high_resolution_clock::now();
 #define TIMER_SAMPLE() time_prev = time_now; time_now = std::chrono::high_resolution_clock::now();
 #ifdef BISMORT_INSTRUMENTATION_VERBOSE
 #define TIMER_REPORT(name) cout << "[Instrumentation] " << (std::string)name+"_us" << " = " << std::chrono::duration_cast<std::chrono::microseconds>(time_now-time_prev).count() << " us" << endl; instrumentationData[name] = (float) (std::chrono::duration_cast<std::chrono::microseconds>(time_now-time_prev).count());
@@ -66,16 +74,29 @@ namespace bismo_rt {
 extern WrapperRegDriver * platform;
 extern BitSerialMatMulAccelDriver * acc;
 extern HardwareCfg cfg;
+extern CompletionMonitor * monitor;
+extern AccelBufferPool * pool;
+extern PlanCache * plans;
+// host-side instruction generator and whether it is used, only accessed with
+// the monitor lock held
+extern InstrGen * igen;
+extern InstrGenSource instrgen_source;
 extern uint32_t accel_p2s_bitpar_buffer;
-extern uint8_t * host_p2s_bitpar_buffer;
 //extern std::vector<InternalLayerDescriptor> registry;
-extern InstrumentationData instrumentationData;
+// per-thread instrumentation data for work outside of any layer, e.g. the
+// self-tests. work on a layer is recorded into its LayerCounters instead.
+extern thread_local InstrumentationData instrumentationData;
 #ifdef BISMORT_INSTRUMENTATION
-extern std::chrono::time_point<std::chrono::high_resolution_clock> time_prev, time_now;
+extern thread_local std::chrono::time_point<std::chrono::high_resolution_clock> time_prev, time_now;
 #endif
 
+// host-side staging memory of the calling thread
+StagingArena * staging();
+
 // internal helper functions
-void p2s(
+// parallel-to-serial conversion, returns the p2s accelerator cycle count or
+// 0 if it ran on the CPU
+uint32_t p2s(
   const uint8_t * host_buf_src,   // input matrix buffer (source)
   uint32_t accel_buf_dst,         // output matrix buffer (destination)
   size_t nrows, size_t ncols,     // matrix size
@@ -84,6 +105,37 @@ void p2s(
   bool zeropad = false,           // use zero instead of random padding
   size_t row_align = 1            // align rows to multiple of this
 );
+// bit-plane transpose on the CPU, produces the same layout as the p2s
+// accelerator for a nrows_a x ncols_a destination (ncols_a multiple of 64).
+// elements outside nrows x ncols are zero.
+void p2s_sw(
+  const uint8_t * src, size_t src_stride, size_t nrows, size_t ncols,
+  uint64_t * dst, size_t nrows_a, size_t ncols_a, size_t nbits, bool issigned
+);
+// copy nrows x ncols of bit-parallel host data (row stride src_stride) into
+// the accelerator bit-parallel buffer, padded to nrows_a x ncols_a, and
+// convert it on the p2s accelerator. dst_plane_stride is the byte offset
+// between destination bit planes. the caller must own the idle accelerator,
+// see CompletionMonitor::lock_idle. returns the p2s cycle count.
+uint32_t p2s_hw(
+  const uint8_t * src, size_t src_stride, size_t nrows, size_t ncols,
+  uint32_t dst, size_t nrows_a, size_t ncols_a, size_t dst_plane_stride,
+  size_t nbits, bool issigned, bool zeropad = true
+);
+// memcpy/memset that are also safe on device (uncached or coherent)
+// mappings when device is set, using only aligned accesses
+void copy_mem(void * dst, const void * src, size_t nbytes, bool device);
+void zero_mem(void * dst, size_t nbytes, bool device);
+// pick HW or SW p2s for converting nbytes of bit-parallel data
+P2SBackend p2s_choose_backend(size_t nbytes);
+// update the p2s cost model with a measured conversion time
+void p2s_record(P2SBackend backend, size_t nbytes, float us);
+// microseconds passed since t0
+inline float us_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<float, std::micro>(
+    std::chrono::steady_clock::now() - t0
+  ).count();
+}
 
 // hardware metrics (non-workload-dependent) for instrumentation
 float getHWPeakBinaryOpsPerCycle();
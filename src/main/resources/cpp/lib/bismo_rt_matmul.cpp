@@ -41,6 +41,8 @@ MatrixMultiply::MatrixMultiply(
   m_rhs = rhs;
   m_res = res;
   m_allow_gemmbitserial = allow_gemmbitserial;
+  m_run_cycles = 0;
+  m_run_open = false;
   // ensure sizes are compatible
   if(m_lhs->inner() != m_rhs->inner()) {
     throw "LHS/RHS dimensions are incompatible";
@@ -58,35 +60,128 @@ MatrixMultiply::MatrixMultiply(
   const size_t tiles_m = m_lhs->outer_a() / cfg.dpaDimLHS;
   const size_t tiles_k = m_lhs->inner_a() / cfg.dpaDimCommon;
   const size_t tiles_n = m_rhs->outer_a() / cfg.dpaDimRHS;
-  const size_t lhs_stripe_nbytes = m_lhs->bitserial_nbytes() / tiles_m;
-  const size_t rhs_stripe_nbytes = m_rhs->bitserial_nbytes() / tiles_n;
-  // must have room for at least one stripe per bit position, as this is the
-  // granularity we at which we do RHS tiling
-  const bool rhs_tile_fits_in_ocm = (acc->get_rhs_total_BRAM_bytes()) >= FETCHEXEC_TOKENS*rhs_stripe_nbytes;
-  const bool rhs_tile_is_one_fetchblock = (rhs_stripe_nbytes <= FETCH_BLOCK_MAX);
-  if(!rhs_tile_is_one_fetchblock || !rhs_tile_fits_in_ocm) {
-    throw "RHS is too large and not currently supported in runtime library.";
+  // bytes for a single bit position of a single DPA-sized tile
+  const size_t lhs_tile_nbytes = (cfg.dpaDimLHS * cfg.dpaDimCommon) / 8;
+  const size_t rhs_tile_nbytes = (cfg.dpaDimRHS * cfg.dpaDimCommon) / 8;
+  const size_t bsize_max = (1 << BISMO_LIMIT_DRAM_BSIZE_BITS) - 1;
+  const size_t boff_max = (1 << BISMO_LIMIT_DRAM_BOFF_BITS) - 1;
+  // M/N tiling: each descriptor covers at most mt x nt result tiles. the
+  // descriptor fields and instrgen loop counters are 16 bits wide, result
+  // rows are written with a stride of the LHS rows in the descriptor, and
+  // each bit position of a single K tile must be reachable with the DRAM
+  // block offset of a fetch instruction.
+  size_t max_tiles_m = std::min(tiles_m, bsize_max);
+  max_tiles_m = std::min(max_tiles_m, bsize_max / (cfg.dpaDimLHS * sizeof(int32_t)));
+  max_tiles_m = std::min(max_tiles_m, boff_max / lhs_tile_nbytes);
+  // use as few chunks as possible, and balance their sizes
+  const size_t nchunks_m = (tiles_m + max_tiles_m - 1) / max_tiles_m;
+  const size_t chunk_tiles_m = (tiles_m + nchunks_m - 1) / nchunks_m;
+  size_t max_tiles_n = std::min(tiles_n, bsize_max);
+  max_tiles_n = std::min(max_tiles_n, boff_max / rhs_tile_nbytes);
+  max_tiles_n = std::min(max_tiles_n, bsize_max / chunk_tiles_m);
+  const size_t nchunks_n = (tiles_n + max_tiles_n - 1) / max_tiles_n;
+  const size_t chunk_tiles_n = (tiles_n + nchunks_n - 1) / nchunks_n;
+  // K tiling: find the largest number of K tiles that can be processed in a
+  // single descriptor. a stripe (all bit positions of a row of tiles) must
+  // be a single fetch block and must fit FETCHEXEC_TOKENS times in OCM, and
+  // each bit position of the input chunks must be reachable with the DRAM
+  // block offset of a fetch instruction.
+  const size_t lhs_stripe_tile_nbytes = m_lhs->bits() * lhs_tile_nbytes;
+  const size_t rhs_stripe_tile_nbytes = m_rhs->bits() * rhs_tile_nbytes;
+  size_t max_tiles_k = tiles_k;
+  max_tiles_k = std::min(max_tiles_k, FETCH_BLOCK_MAX / lhs_stripe_tile_nbytes);
+  max_tiles_k = std::min(max_tiles_k, FETCH_BLOCK_MAX / rhs_stripe_tile_nbytes);
+  max_tiles_k = std::min(max_tiles_k, acc->get_lhs_total_BRAM_bytes() / (FETCHEXEC_TOKENS * lhs_stripe_tile_nbytes));
+  max_tiles_k = std::min(max_tiles_k, acc->get_rhs_total_BRAM_bytes() / (FETCHEXEC_TOKENS * rhs_stripe_tile_nbytes));
+  max_tiles_k = std::min(max_tiles_k, boff_max / (chunk_tiles_m * lhs_tile_nbytes));
+  max_tiles_k = std::min(max_tiles_k, boff_max / (chunk_tiles_n * rhs_tile_nbytes));
+  if(max_tiles_k == 0) {
+    throw "Matrix multiply is too large even with K tiling, not currently supported in runtime library.";
   }
-  const bool lhs_tile_fits_in_ocm = (acc->get_lhs_total_BRAM_bytes()) >= FETCHEXEC_TOKENS*lhs_stripe_nbytes;
-  const bool lhs_tile_is_one_fetchblock = lhs_stripe_nbytes <= FETCH_BLOCK_MAX;
-  if(!lhs_tile_is_one_fetchblock || !lhs_tile_fits_in_ocm) {
-    throw "LHS is too large and not currently supported in runtime library.";
+  const size_t nchunks_k = (tiles_k + max_tiles_k - 1) / max_tiles_k;
+  const size_t chunk_tiles_k = (tiles_k + nchunks_k - 1) / nchunks_k;
+  m_lhs->set_inner_chunk(chunk_tiles_k * cfg.dpaDimCommon);
+  m_rhs->set_inner_chunk(chunk_tiles_k * cfg.dpaDimCommon);
+  m_lhs->set_outer_chunk(chunk_tiles_m * cfg.dpaDimLHS);
+  m_rhs->set_outer_chunk(chunk_tiles_n * cfg.dpaDimRHS);
+  if(nchunks_m > 1) {
+    // the result rows of each M chunk are stored as a separate matrix
+    m_res->set_inner_chunk(chunk_tiles_m * cfg.dpaDimLHS);
+  }
+  // the K chunks can accumulate into the exec stage accumulators and only
+  // the last one writes the result. the accumulators hold a single result
+  // tile and are doubled between bit positions, so this is only exact for a
+  // single result tile with binary inputs.
+  const size_t last_chunk = m_lhs->num_inner_chunks() - 1;
+  m_k_accumulate = (last_chunk > 0) && (tiles_m == 1) && (tiles_n == 1) &&
+    (m_lhs->bits() == 1) && (m_rhs->bits() == 1);
+  // otherwise each K chunk produces a partial result, the first one is
+  // written into the result matrix and the rest into temporary ones that are
+  // summed on the host
+  for(size_t c = 1; c <= last_chunk && !m_k_accumulate; c++) {
+    m_res_partial.push_back(new Matrix<int32_t>(
+      m_res->inner(), m_res->outer(), 32, true, true, matTypeRes,
+      "mat_res_partial", platform->is_coherent()
+    ));
+    if(nchunks_m > 1) {
+      m_res_partial.back()->set_inner_chunk(chunk_tiles_m * cfg.dpaDimLHS);
+    }
+  }
+  // loop order over the result tiles: the stationary operand is read once,
+  // the other one once for each tile of the stationary operand within the
+  // same M/N chunk. if the LHS of a K chunk fits into one of the
+  // FETCHEXEC_TOKENS buffer regions (the fetch stage fills the others ahead
+  // of time), it can stay there for all RHS tiles and both are read once.
+  // pick the one that reads the fewest bytes from DRAM, RHS-stationary on a
+  // tie.
+  const size_t rd_rhs_stationary = rhsBytes() * nchunks_m + lhsBytes() * tiles_n;
+  const size_t rd_lhs_stationary = lhsBytes() * nchunks_n + rhsBytes() * tiles_m;
+  const size_t rd_lhs_resident = lhsBytes() * nchunks_n + rhsBytes() * nchunks_m;
+  const size_t lhs_chunk_nbytes = chunk_tiles_m * chunk_tiles_k * lhs_stripe_tile_nbytes;
+  const bool lhs_fits_region = lhs_chunk_nbytes <= acc->get_lhs_total_BRAM_bytes() / FETCHEXEC_TOKENS;
+  uint8_t tiling = tilingRHSLHS;
+  size_t rd_min = rd_rhs_stationary;
+  if(rd_lhs_stationary < rd_min) {
+    tiling = tilingLHSRHS;
+    rd_min = rd_lhs_stationary;
+  }
+  if(lhs_fits_region && rd_lhs_resident < rd_min) {
+    tiling = tilingLHSResident;
+    rd_min = rd_lhs_resident;
+  }
+  m_fetch_bytes = rd_min;
+  // create and fill in one descriptor per M/N/K chunk, all K chunks of a
+  // result chunk are consecutive so that they can accumulate
+  for(size_t mc = 0; mc < m_lhs->num_outer_chunks(); mc++) {
+    for(size_t nc = 0; nc < m_rhs->num_outer_chunks(); nc++) {
+      for(size_t c = 0; c <= last_chunk; c++) {
+        SingleMMDescriptor dsc;
+        dsc.tiles_m = m_lhs->outer_chunk_a(mc) / cfg.dpaDimLHS;
+        dsc.tiles_k = m_lhs->inner_chunk_a(c) / cfg.dpaDimCommon;
+        dsc.tiles_n = m_rhs->outer_chunk_a(nc) / cfg.dpaDimRHS;
+        dsc.bits_l = m_lhs->bits();
+        dsc.bits_r = m_rhs->bits();
+        dsc.signed_l = m_lhs->is_signed();
+        dsc.signed_r = m_rhs->is_signed();
+        dsc.base_l = 0;
+        dsc.base_r = 0;
+        dsc.base_res = 0;
+        dsc.accumulate = m_k_accumulate && (c > 0);
+        dsc.defer_writeback = m_k_accumulate && (c < last_chunk);
+        dsc.nbufs_fetch_exec_log2 = FETCHEXEC_TOKENS_LOG2;
+        dsc.tiling = tiling;
+        dsc.dram_lhs = m_lhs->bitserial_accelbuf(mc, c);
+        dsc.dram_rhs = m_rhs->bitserial_accelbuf(nc, c);
+        // the result is transposed, the M chunk is an inner chunk of it
+        Matrix<int32_t> * res = (c == 0 || m_k_accumulate) ? m_res : m_res_partial[c-1];
+        const size_t res_chunk_a = res->inner_chunk_a(mc);
+        const size_t res_offset = res->outer_a() * mc * res->inner_chunk() +
+          nc * m_rhs->outer_chunk() * res_chunk_a;
+        dsc.dram_res = res->accelbuf() + res_offset * sizeof(int32_t);
+        m_igen_dsc.push_back(dsc);
+      }
+    }
   }
-  // create and fill in the descriptor
-  m_igen_dsc.tiles_m = tiles_m;
-  m_igen_dsc.tiles_k = tiles_k;
-  m_igen_dsc.tiles_n = tiles_n;
-  m_igen_dsc.bits_l = m_lhs->bits();
-  m_igen_dsc.bits_r = m_rhs->bits();
-  m_igen_dsc.signed_l = m_lhs->is_signed();
-  m_igen_dsc.signed_r = m_rhs->is_signed();
-  m_igen_dsc.base_l = 0;
-  m_igen_dsc.base_r = 0;
-  m_igen_dsc.base_res = 0;
-  m_igen_dsc.nbufs_fetch_exec_log2 = FETCHEXEC_TOKENS_LOG2;
-  m_igen_dsc.dram_lhs = m_lhs->bitserial_accelbuf();
-  m_igen_dsc.dram_rhs = m_rhs->bitserial_accelbuf();
-  m_igen_dsc.dram_res = m_res->accelbuf();
 };
 
 // note: deallocation of MatrixMultiply does NOT free the LHS/RHS/res matrices
@@ -94,6 +189,9 @@ MatrixMultiply::~MatrixMultiply() {
   if(m_allow_gemmbitserial) {
     gemmbitserial::deallocGEMMContext(m_cpu_ctx);
   }
+  for(auto & res_partial : m_res_partial) {
+    delete res_partial;
+  }
 };
 
 bool MatrixMultiply::has_cpu_ctx() const {
@@ -109,24 +207,123 @@ gemmbitserial::GEMMContext MatrixMultiply::getCPUContext() {
 }
 
 void MatrixMultiply::exec() {
-  acc->set_stage_enables(0, 0, 0);
-  acc->useDescriptors();
-  // feed the instrgen descriptor
-  acc->pushSingleMMDescriptor(m_igen_dsc);
-  // HACK: make sure at least one op has appeared before checking for completion
-  // proper way to fix this is to singal completion from accel explicitly
-  while(acc->res_opcount() == 0) {};
-  // start the cycle counter
-  acc->perf_set_cc_enable(1);
-  // enable all stages
-  acc->set_stage_enables(1, 1, 1);
-  // wait until all writes are completed
-  while(acc->res_opcount() != 0) {};
-  // stop the cycle counter
-  acc->perf_set_cc_enable(0);
-  acc->set_stage_enables(0, 0, 0);
+  monitor->wait(monitor->submit(this));
+};
+
+size_t MatrixMultiply::start(
+  std::deque<SingleMMDescriptor> & dsc, std::deque<BISMOInstruction> & ins
+) {
+  if(instrgen_source == instrGenHost) {
+    // generate the instructions for all descriptors on the host, they are
+    // fed directly since the pipeline was started in that mode. each
+    // descriptor still ends with a result nop that increments the
+    // descriptor count.
+    InstrStreams streams;
+    for(auto & d : m_igen_dsc) {
+      igen->generate(d, streams);
+    }
+    std::vector<BISMOInstruction> interleaved;
+    InstrGen::interleave(streams, interleaved, acc->execres_tokens());
+    ins.insert(ins.end(), interleaved.begin(), interleaved.end());
+  } else {
+    // queue the instrgen descriptors
+    dsc.insert(dsc.end(), m_igen_dsc.begin(), m_igen_dsc.end());
+  }
+  return m_igen_dsc.size();
 };
 
+size_t MatrixMultiply::num_descriptors() const {
+  return m_igen_dsc.size();
+}
+
+void MatrixMultiply::finish(uint64_t cycles) {
+  m_run_cycles = cycles;
+  if(instr_level() != instrOff) {
+    m_counters.record(ctrRunCycles, cycles);
+  }
+};
+
+void MatrixMultiply::syncResult() {
+  m_res->accel2host();
+  // sum up the partial results from K tiling
+  int32_t * res = m_res->hostbuf();
+  for(auto & res_partial : m_res_partial) {
+    res_partial->accel2host();
+    int32_t * part = res_partial->hostbuf();
+    for(size_t i = 0; i < m_res->elems(); i++) {
+      res[i] += part[i];
+    }
+  }
+}
+
+void MatrixMultiply::syncResult(size_t row0, size_t nrows, size_t col0, size_t ncols) {
+  // the result is stored transposed: outer = columns, inner = rows
+  m_res->accel2host(col0, col0 + ncols, row0, row0 + nrows);
+  int32_t * res = m_res->hostbuf();
+  for(auto & res_partial : m_res_partial) {
+    res_partial->accel2host(col0, col0 + ncols, row0, row0 + nrows);
+    int32_t * part = res_partial->hostbuf();
+    for(size_t c = col0; c < col0 + ncols; c++) {
+      for(size_t r = row0; r < row0 + nrows; r++) {
+        res[c * M() + r] += part[c * M() + r];
+      }
+    }
+  }
+}
+
+uint64_t MatrixMultiply::getLastRunCycles() const {
+  return m_run_cycles;
+}
+
+InstrumentationData & MatrixMultiply::instrumentation() {
+  m_instr.clear();
+  m_counters.export_to(m_instr, instr_level() == instrDetailed);
+  return m_instr;
+}
+
+LayerCounters & MatrixMultiply::counters() {
+  return m_counters;
+}
+
+void MatrixMultiply::begin_run() {
+  if(!m_run_open && instr_level() != instrOff) {
+    m_run_open = true;
+    m_run_start = std::chrono::steady_clock::now();
+  }
+}
+
+void MatrixMultiply::end_run() {
+  if(m_run_open) {
+    m_run_open = false;
+    m_counters.record(ctrEndToEnd, std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - m_run_start
+    ).count());
+  }
+}
+
+std::mutex & MatrixMultiply::lock() {
+  return m_lock;
+}
+
+size_t MatrixMultiply::accelBytes() const {
+  size_t ret = m_lhs->accel_nbytes() + m_rhs->accel_nbytes() + m_res->accel_nbytes();
+  for(auto & res_partial : m_res_partial) {
+    ret += res_partial->accel_nbytes();
+  }
+  return ret;
+}
+
+void MatrixMultiply::recycle() {
+  m_lhs->set_constant(false);
+  m_rhs->set_constant(false);
+  m_lhs->bind(0, 0);
+  m_rhs->bind(0, 0);
+  m_counters.reset();
+  m_instr.clear();
+  m_run_cycles = 0;
+  m_run_open = false;
+}
+
 size_t MatrixMultiply::M() const {
   return m_lhs->outer();
 }
@@ -153,7 +350,7 @@ size_t MatrixMultiply::resBytes() const {
 
 size_t MatrixMultiply::getNumBytesToFetch() const {
   // note that the number of bytes to fetch depends on the tiling strategy
-  // our current tiling strategy looks like this:
+  // the RHS-stationary tiling looks like this:
   // (see FetchInstrGen.cpp for HLS implementation)
   // foreach n in n_tiles:
   //    load slice n into on-chip memory
@@ -162,11 +359,30 @@ size_t MatrixMultiply::getNumBytesToFetch() const {
   //      process the loaded slices
   // m is slices of the LHS matrix and n is slices of the RHS matrix
   // thus, RHS gets loaded only once, but LHS is loaded multiple (n_tiles) times
-  return rhsBytes() + (lhsBytes() * m_igen_dsc.tiles_n);
+  // the LHS-stationary tiling swaps the loops, and the roles of LHS and RHS
+  // with a resident LHS, all LHS slices are loaded once before the n loop
+  // K tiling does not change this, as each K chunk is fetched in the same way
+  // with M/N tiling, the stationary operand is read once per chunk of the
+  // other one. the constructor picks the tiling and keeps its byte count.
+  return m_fetch_bytes;
+}
+
+bool MatrixMultiply::isLHSStationary() const {
+  return m_igen_dsc[0].tiling == tilingLHSRHS;
+}
+
+bool MatrixMultiply::isLHSResident() const {
+  return m_igen_dsc[0].tiling == tilingLHSResident;
+}
+
+bool MatrixMultiply::isKAccumulated() const {
+  return m_k_accumulate;
 }
 
 size_t MatrixMultiply::getNumBytesToWrite() const {
-  return resBytes();
+  // one (partial) result per K chunk, unless the chunks are accumulated in
+  // the accelerator
+  return resBytes() * (m_res_partial.size() + 1);
 }
 
 float MatrixMultiply::getWorkloadOpCount(bool inclPadding) const {
@@ -183,7 +399,7 @@ float MatrixMultiply::getWorkloadBinaryOpCount(bool inclPadding) const {
 
 float MatrixMultiply::getLastRunBinaryGOPS(bool inclPadding) const {
   // giga-ops per second = ops per nanosecond
-  return getWorkloadBinaryOpCount(inclPadding) / getLastRuntimeNanoseconds();
+  return getWorkloadBinaryOpCount(inclPadding) / (getLastRunCycles() * getNanosecondsPerCycle());
 }
 
 float MatrixMultiply::getWorkloadReadOI() const {
@@ -207,86 +423,92 @@ float MatrixMultiply::getWorkloadOI() const {
 }
 
 void MatrixMultiply::perfSummary() {
-  instrumentationData["workload_total_binops"] = getWorkloadBinaryOpCount(true);
-  instrumentationData["workload_actual_binops"] = getWorkloadBinaryOpCount(false);
-  instrumentationData["workload_lhs_bytes"] = lhsBytes();
-  instrumentationData["workload_rhs_bytes"] = rhsBytes();
-  instrumentationData["workload_res_bytes"] = resBytes();
-  instrumentationData["hw_buf_size_bytes"] = getHWBufSize();
-  instrumentationData["hw_peak_perf_binops"] = getHWPeakBinaryGOPS();
-  instrumentationData["hw_fclk_mhz"] = acc->fclk_MHz();
-  instrumentationData["workload_read_oi"] = getWorkloadReadOI();
-  instrumentationData["workload_write_oi"] = getWorkloadWriteOI();
-  instrumentationData["actual_read_oi"] = getActualReadOI();
-  instrumentationData["actual_write_oi"] = getActualWriteOI();
-  instrumentationData["hw_peak_read_oi"] = getHWCompBoundReadOI();
-  instrumentationData["hw_peak_write_oi"] = getHWCompBoundWriteOI();
-  instrumentationData["run_cycles"] = getLastRuntimeCycles();
-  instrumentationData["run_achieved_binops"] = getLastRunBinaryGOPS();
+  m_instr["workload_total_binops"] = getWorkloadBinaryOpCount(true);
+  m_instr["workload_actual_binops"] = getWorkloadBinaryOpCount(false);
+  m_instr["workload_lhs_bytes"] = lhsBytes();
+  m_instr["workload_rhs_bytes"] = rhsBytes();
+  m_instr["workload_res_bytes"] = resBytes();
+  m_instr["tiling_lhs_stationary"] = isLHSStationary() ? 1 : 0;
+  m_instr["tiling_lhs_resident"] = isLHSResident() ? 1 : 0;
+  m_instr["tiling_k_accumulated"] = isKAccumulated() ? 1 : 0;
+  m_instr["hw_buf_size_bytes"] = getHWBufSize();
+  m_instr["hw_peak_perf_binops"] = getHWPeakBinaryGOPS();
+  m_instr["hw_fclk_mhz"] = acc->fclk_MHz();
+  m_instr["workload_read_oi"] = getWorkloadReadOI();
+  m_instr["workload_write_oi"] = getWorkloadWriteOI();
+  m_instr["actual_read_oi"] = getActualReadOI();
+  m_instr["actual_write_oi"] = getActualWriteOI();
+  m_instr["hw_peak_read_oi"] = getHWCompBoundReadOI();
+  m_instr["hw_peak_write_oi"] = getHWCompBoundWriteOI();
+  m_instr["run_cycles"] = getLastRunCycles();
+  m_instr["run_achieved_binops"] = getLastRunBinaryGOPS();
 #ifdef BISMORT_INSTRUMENTATION_VERBOSE
   std::cout << "Performance Summary ====================================" << std::endl;
-  std::cout << "Total workload: " << instrumentationData["workload_total_binops"] << " binary ops" << std::endl;
-  std::cout << "Useful workload: " << instrumentationData["workload_actual_binops"] << " binary ops ";
-  std::cout << "(" << 100*instrumentationData["workload_total_binops"]/instrumentationData["workload_actual_binops"] << "%)" << std::endl;
-  std::cout << "Input matrix bytes: LHS " << instrumentationData["workload_lhs_bytes"] << " RHS " << instrumentationData["workload_rhs_bytes"] << std::endl;
-  std::cout << "Result matrix bytes: " << instrumentationData["workload_res_bytes"] << std::endl;
-  std::cout << "HW input matrix buffer bytes: " << instrumentationData["hw_buf_size_bytes"] << std::endl;
-  std::cout << "HW peak perf: " << instrumentationData["hw_peak_perf_binops"] << " binary GOPS" << std::endl;
-  std::cout << "HW fclk: " << instrumentationData["hw_fclk_mhz"] << " MHz" << std::endl;
-  std::cout << "Workload OI read: " << instrumentationData["workload_read_oi"];
-  std::cout << " write: " << instrumentationData["workload_write_oi"] << std::endl;
-  std::cout << "Implementation OI read: " << instrumentationData["actual_read_oi"];
-  std::cout << " write: " << instrumentationData["actual_write_oi"] << std::endl;
-  std::cout << "HW comp-bound OI read: " << instrumentationData["hw_peak_read_oi"];
-  std::cout << " write: " << instrumentationData["hw_peak_write_oi"] << std::endl;
-  std::cout << "Achieved: " << instrumentationData["run_achieved_binops"] << " binary GOPS (";
-  std::cout << 100*instrumentationData["run_achieved_binops"] / instrumentationData["hw_peak_perf_binops"] << "%)" << std::endl;
-  std::cout << "Runtime: " << instrumentationData["run_cycles"] << " cycles, ";
-  std::cout << getLastRuntimeNanoseconds() << " ns" << std::endl;
+  std::cout << "Total workload: " << m_instr["workload_total_binops"] << " binary ops" << std::endl;
+  std::cout << "Useful workload: " << m_instr["workload_actual_binops"] << " binary ops ";
+  std::cout << "(" << 100*m_instr["workload_total_binops"]/m_instr["workload_actual_binops"] << "%)" << std::endl;
+  std::cout << "Input matrix bytes: LHS " << m_instr["workload_lhs_bytes"] << " RHS " << m_instr["workload_rhs_bytes"] << std::endl;
+  std::cout << "Tiling: " << (isLHSStationary() ? "LHS" : "RHS") << "-stationary";
+  std::cout << (isLHSResident() ? ", LHS resident" : "");
+  std::cout << (isKAccumulated() ? ", K chunks accumulated on chip" : "") << std::endl;
+  std::cout << "Result matrix bytes: " << m_instr["workload_res_bytes"] << std::endl;
+  std::cout << "HW input matrix buffer bytes: " << m_instr["hw_buf_size_bytes"] << std::endl;
+  std::cout << "HW peak perf: " << m_instr["hw_peak_perf_binops"] << " binary GOPS" << std::endl;
+  std::cout << "HW fclk: " << m_instr["hw_fclk_mhz"] << " MHz" << std::endl;
+  std::cout << "Workload OI read: " << m_instr["workload_read_oi"];
+  std::cout << " write: " << m_instr["workload_write_oi"] << std::endl;
+  std::cout << "Implementation OI read: " << m_instr["actual_read_oi"];
+  std::cout << " write: " << m_instr["actual_write_oi"] << std::endl;
+  std::cout << "HW comp-bound OI read: " << m_instr["hw_peak_read_oi"];
+  std::cout << " write: " << m_instr["hw_peak_write_oi"] << std::endl;
+  std::cout << "Achieved: " << m_instr["run_achieved_binops"] << " binary GOPS (";
+  std::cout << 100*m_instr["run_achieved_binops"] / m_instr["hw_peak_perf_binops"] << "%)" << std::endl;
+  std::cout << "Runtime: " << m_instr["run_cycles"] << " cycles, ";
+  std::cout << getLastRunCycles() * getNanosecondsPerCycle() << " ns" << std::endl;
   std::cout << "========================================================" << std::endl;
 #endif
 }
 
 void MatrixMultiply::perfDetails() {
   size_t rd_total = (getNumBytesToFetch());
-  float rd_bw = (float) rd_total / getLastRuntimeCycles();
+  float rd_bw = (float) rd_total / getLastRunCycles();
   float rd_fetchact_bw = (float) getNumBytesToFetch() / acc->getStateBreakdown(stgFetch, csRun);
-  float wr_bw = (float)getNumBytesToWrite() / getLastRuntimeCycles();
+  float wr_bw = (float)getNumBytesToWrite() / getLastRunCycles();
   float wr_resact_bw = (float) getNumBytesToWrite() / acc->getStateBreakdown(stgResult, csRun);
   float exec_eff = getWorkloadBinaryOpCount(true) / ((acc->getStateBreakdown(stgExec, csRun) * getHWPeakBinaryOpsPerCycle()));
-  instrumentationData["workload_dram_read_bytes"] = rd_total;
-  instrumentationData["workload_dram_write_bytes"] = getNumBytesToWrite();
-  instrumentationData["hw_peak_read_bw"] = getHWReadBW();
-  instrumentationData["hw_peak_write_bw"] = getHWWriteBW();
+  m_instr["workload_dram_read_bytes"] = rd_total;
+  m_instr["workload_dram_write_bytes"] = getNumBytesToWrite();
+  m_instr["hw_peak_read_bw"] = getHWReadBW();
+  m_instr["hw_peak_write_bw"] = getHWWriteBW();
   // per-stage state breakdown
-  instrumentationData["stg_fetch_idle"] = acc->getStateBreakdown(stgFetch, csGetCmd);
-  instrumentationData["stg_exec_idle"] = acc->getStateBreakdown(stgExec, csGetCmd);
-  instrumentationData["stg_result_idle"] = acc->getStateBreakdown(stgResult, csGetCmd);
-  instrumentationData["stg_fetch_run"] = acc->getStateBreakdown(stgFetch, csRun);
-  instrumentationData["stg_exec_run"] = acc->getStateBreakdown(stgExec, csRun);
-  instrumentationData["stg_result_run"] = acc->getStateBreakdown(stgResult, csRun);
-  instrumentationData["stg_fetch_snd"] = acc->getStateBreakdown(stgFetch, csSend);
-  instrumentationData["stg_exec_snd"] = acc->getStateBreakdown(stgExec, csSend);
-  instrumentationData["stg_result_snd"] = acc->getStateBreakdown(stgResult, csSend);
-  instrumentationData["stg_fetch_rcv"] = acc->getStateBreakdown(stgFetch, csReceive);
-  instrumentationData["stg_exec_rcv"] = acc->getStateBreakdown(stgExec, csReceive);
-  instrumentationData["stg_result_rcv"] = acc->getStateBreakdown(stgResult, csReceive);
+  m_instr["stg_fetch_idle"] = acc->getStateBreakdown(stgFetch, csGetCmd);
+  m_instr["stg_exec_idle"] = acc->getStateBreakdown(stgExec, csGetCmd);
+  m_instr["stg_result_idle"] = acc->getStateBreakdown(stgResult, csGetCmd);
+  m_instr["stg_fetch_run"] = acc->getStateBreakdown(stgFetch, csRun);
+  m_instr["stg_exec_run"] = acc->getStateBreakdown(stgExec, csRun);
+  m_instr["stg_result_run"] = acc->getStateBreakdown(stgResult, csRun);
+  m_instr["stg_fetch_snd"] = acc->getStateBreakdown(stgFetch, csSend);
+  m_instr["stg_exec_snd"] = acc->getStateBreakdown(stgExec, csSend);
+  m_instr["stg_result_snd"] = acc->getStateBreakdown(stgResult, csSend);
+  m_instr["stg_fetch_rcv"] = acc->getStateBreakdown(stgFetch, csReceive);
+  m_instr["stg_exec_rcv"] = acc->getStateBreakdown(stgExec, csReceive);
+  m_instr["stg_result_rcv"] = acc->getStateBreakdown(stgResult, csReceive);
   // derived per-stage efficiency metrics
-  instrumentationData["run_eff%_fetch"] = 100*rd_fetchact_bw/getHWReadBW();
-  instrumentationData["run_eff%_exec"] = 100*exec_eff;
-  instrumentationData["run_eff%_result"] = 100*wr_resact_bw/getHWWriteBW();
+  m_instr["run_eff%_fetch"] = 100*rd_fetchact_bw/getHWReadBW();
+  m_instr["run_eff%_exec"] = 100*exec_eff;
+  m_instr["run_eff%_result"] = 100*wr_resact_bw/getHWWriteBW();
 #ifdef BISMORT_INSTRUMENTATION_VERBOSE
   int colwidth = 11;
   acc->printStateBreakdown();
   std::cout << "Memory System ==========================================" << std::endl;
-  std::cout << "Total DRAM reads: " << instrumentationData["workload_dram_read_bytes"] << " bytes" << std::endl;
-  std::cout << "HW theoretical peak read bandwidth: " << instrumentationData["hw_peak_read_bw"] << " bytes/cycle" << std::endl;
+  std::cout << "Total DRAM reads: " << m_instr["workload_dram_read_bytes"] << " bytes" << std::endl;
+  std::cout << "HW theoretical peak read bandwidth: " << m_instr["hw_peak_read_bw"] << " bytes/cycle" << std::endl;
   std::cout << "Average DRAM read bandwidth: " << rd_bw << " bytes/cycle (";
   std::cout << 100*rd_bw/getHWReadBW() << "%)" << std::endl;
   std::cout << "Fetch efficiency: " << rd_fetchact_bw << " bytes/cycle (";
   std::cout << 100*rd_fetchact_bw/getHWReadBW() << "%)" << std::endl;
-  std::cout << "DRAM writes: " << instrumentationData["workload_dram_write_bytes"] << " bytes" << std::endl;
-  std::cout << "HW theoretical peak wr bandwidth: " << instrumentationData["hw_peak_write_bw"] << " bytes/cycle" << std::endl;
+  std::cout << "DRAM writes: " << m_instr["workload_dram_write_bytes"] << " bytes" << std::endl;
+  std::cout << "HW theoretical peak wr bandwidth: " << m_instr["hw_peak_write_bw"] << " bytes/cycle" << std::endl;
   std::cout << "Effective wr bandwidth: " << wr_bw << " bytes/cycle (";
   std::cout << 100*wr_bw/getHWWriteBW() << "%)" << std::endl;
   std::cout << "Result wr bandwidth: " << wr_resact_bw << " bytes/cycle (";
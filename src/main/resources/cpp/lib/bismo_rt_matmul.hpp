@@ -52,9 +52,29 @@ public:
   );
   // free matrix multiply operation, does NOT free input/output matrices
   ~MatrixMultiply();
-  // execute matrix multiply on accelerator
+  // execute matrix multiply on accelerator and wait for completion
   // does not synchronize input Matrix objects, remember to call host2accel
   void exec();
+  // hand the descriptors (or the instructions generated from them on the
+  // host, see setInstrGenSource) to the accelerator without waiting for
+  // completion, only called through the CompletionMonitor which manages the
+  // pipeline. descriptors (or instructions) are appended to dsc (or ins),
+  // which the CompletionMonitor feeds to the accelerator as its queues have
+  // room. returns the number of descriptors.
+  size_t start(
+    std::deque<SingleMMDescriptor> & dsc, std::deque<BISMOInstruction> & ins
+  );
+  // number of descriptors start() produces, one per K chunk
+  size_t num_descriptors() const;
+  // called by the CompletionMonitor once the accelerator has finished,
+  // with the number of cycles this matrix multiply occupied the accelerator
+  void finish(uint64_t cycles);
+  // number of cycles taken by the most recent accelerator run
+  uint64_t getLastRunCycles() const;
+  // copy the result matrix to the host, summing up K-tiled partial results
+  void syncResult();
+  // as above, but only for the given rows and columns of the result
+  void syncResult(size_t row0, size_t nrows, size_t col0, size_t ncols);
   // whether CPU-only execution is enabled
   bool has_cpu_ctx() const;
   // return gemmbitserial handle for CPU-only execution
@@ -68,6 +88,15 @@ public:
   size_t rhsBytes() const;
   size_t resBytes() const;
   size_t getNumBytesToFetch() const;
+  // whether the tiles are computed LHS-stationary (each LHS tile fetched
+  // once) instead of RHS-stationary, chosen for the fewest DRAM reads
+  bool isLHSStationary() const;
+  // whether the entire LHS (of each K chunk) is fetched once and kept on chip
+  // for all RHS tiles, chosen when it fits and reads fewer bytes than both
+  bool isLHSResident() const;
+  // whether the K chunks accumulate into the accelerator's accumulators, so
+  // that only the last one writes the result (no partial results)
+  bool isKAccumulated() const;
   size_t getNumBytesToWrite() const;
   float getWorkloadOpCount(bool inclPadding = true) const;
   float getWorkloadBinaryOpCount(bool inclPadding = true) const;
@@ -77,16 +106,57 @@ public:
   float getActualReadOI() const;
   float getActualWriteOI() const;
   float getWorkloadOI() const;
-  // get performance summary and details (saved into bismo_rt::instrumentationData)
+  // get performance summary and details (saved into instrumentation())
   void perfSummary();
   void perfDetails();
+  // build the instrumentation data from the counters and return it
+  InstrumentationData & instrumentation();
+  // instrumentation counters recorded for this matrix multiply
+  LayerCounters & counters();
+  // end-to-end latency: a run starts with the first input sync or submit
+  // after the previous run's results were synced, and ends when they are
+  void begin_run();
+  void end_run();
+  // serializes host-side operations on this matrix multiply and its matrices
+  std::mutex & lock();
+  // accelerator memory used by the matrices of this matrix multiply
+  size_t accelBytes() const;
+  // forget the instrumentation, run state, dirty ranges, bound caller memory
+  // and constant flags, so that the matrix multiply can be reused for a new
+  // layer of the same shape. the matrix contents are not cleared.
+  void recycle();
   // lhs/rhs/res member matrices, exposed for the sake of the API wrapper
   Matrix<uint8_t> * m_lhs, * m_rhs;
   Matrix<int32_t> * m_res;
 protected:
-  SingleMMDescriptor m_igen_dsc;
+  // one descriptor per M/N/K chunk
+  std::vector<SingleMMDescriptor> m_igen_dsc;
+  // partial results for all but the first K chunk
+  std::vector<Matrix<int32_t> *> m_res_partial;
+  // K chunks accumulated in the accelerator instead of m_res_partial
+  bool m_k_accumulate;
+  // bytes read from DRAM by the chosen tiling, see getNumBytesToFetch
+  size_t m_fetch_bytes;
   gemmbitserial::GEMMContext m_cpu_ctx;
   bool m_allow_gemmbitserial;
+  // written by the CompletionMonitor with its lock held
+  uint64_t m_run_cycles;
+  LayerCounters m_counters;
+  bool m_run_open;
+  std::chrono::steady_clock::time_point m_run_start;
+  // built from m_counters on request
+  InstrumentationData m_instr;
+  std::mutex m_lock;
+};
+
+// locks a matrix multiply against use from other threads and records the
+// instrumentation of the calling thread into it while in scope
+class LayerScope {
+public:
+  LayerScope(MatrixMultiply * mm) : m_lock(mm->lock()), m_instr(mm->counters()) {};
+protected:
+  std::lock_guard<std::mutex> m_lock;
+  InstrumentationScope m_instr;
 };
 
 }
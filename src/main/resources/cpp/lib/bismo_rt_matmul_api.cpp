@@ -37,9 +37,15 @@ namespace bismo_rt {
 // note that the MatMul calls here simply implement wrappers around the
 // MatrixMultiply class. this is to allow the BISMO RT to be compiled as a
 // shared library, also removing the need for the template classes implemented
-// as header files to be included with the rtlib
+// as header files to be included with the rtlib.
+// calls on different layers can be made from different threads at the same
+// time. calls on the same layer are serialized by its LayerScope.
 
 LayerHandle initMatMul(MatMulDescriptor & dsc) {
+  MatrixMultiply * cached = plans->acquire(dsc);
+  if(cached) {
+    return (LayerHandle) cached;
+  }
   bool is_coherent = platform->is_coherent();
   Matrix<uint8_t> * lhs = new Matrix<uint8_t>(
     dsc.M, dsc.K, dsc.wbits, dsc.wsigned, false, matTypeLHS, "mat_lhs", is_coherent
@@ -62,12 +68,14 @@ LayerHandle initMatMul(MatMulDescriptor & dsc) {
 
 void execMatMul(LayerHandle id) {
   MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->begin_run();
   mm->exec();
   if(mm->has_cpu_ctx()) {
     gemmbitserial::GEMMContext ctx = mm->getCPUContext();
     gemmbitserial::gemmBitSerial(ctx);
 #ifdef BISMORT_MATMUL_VERIFY_AGAINST_CPU
-    mm->m_res->accel2host();
+    mm->syncResult();
     size_t nbytes_res = mm->M()*mm->N()*sizeof(int32_t);
     int verify_res = memcmp(ctx.res, mm->m_res->hostbuf(), nbytes_res);
     std::cout << "CPU vs accel verification result = " << verify_res << std::endl;
@@ -75,12 +83,63 @@ void execMatMul(LayerHandle id) {
   }
 }
 
+CompletionHandle submitMatMul(LayerHandle id) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->begin_run();
+  return monitor->submit(mm);
+}
+
+bool pollMatMul(CompletionHandle h) {
+  return monitor->poll(h);
+}
+
+bool waitMatMul(CompletionHandle h, uint64_t timeout_us) {
+  return monitor->wait(h, timeout_us);
+}
+
 InstrumentationData getInstrumentationData(LayerHandle id) {
   MatrixMultiply * mm = (MatrixMultiply *) id;
-  acc->updateStateBreakdown();
+  LayerScope scope(mm);
+  const bool detailed = (getInstrumentationLevel() == instrDetailed);
+  std::unique_lock<std::mutex> accel_lock;
+  if(detailed) {
+    // stage breakdown counters cover everything run since the pipeline was
+    // last started, so let the whole queue finish and keep it idle meanwhile
+    accel_lock = monitor->lock_idle();
+    acc->updateStateBreakdown();
+  } else {
+    monitor->drain(mm);
+  }
+  // the string-keyed map is only built here, recording uses fixed counters
+  InstrumentationData & data = mm->instrumentation();
+  data["pool_bytes_reserved"] = pool->bytes_reserved();
+  data["pool_bytes_in_use"] = pool->bytes_in_use();
+  data["pool_fragmentation"] = pool->fragmentation();
+  data["plan_cache_bytes"] = plans->bytes_cached();
+  data["plan_cache_hits"] = plans->num_hits();
+  data["plan_cache_misses"] = plans->num_misses();
+  data["staging_high_water_bytes"] = StagingArena::overall_high_water();
   mm->perfSummary();
-  mm->perfDetails();
-  return instrumentationData;
+  if(detailed) {
+    mm->perfDetails();
+  }
+  return data;
+}
+
+LatencyStats getLatencyStats(LayerHandle id) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  // accelerator cycles are recorded by the CompletionMonitor
+  std::unique_lock<std::mutex> monitor_lock = monitor->lock();
+  return mm->counters().latency_stats();
+}
+
+void resetLatencyStats(LayerHandle id) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  std::unique_lock<std::mutex> monitor_lock = monitor->lock();
+  mm->counters().reset_latency_stats();
 }
 
 uint8_t * getLayerLHSBuffer(LayerHandle id) {
@@ -100,33 +159,110 @@ int32_t * getLayerResBuffer(LayerHandle id) {
 
 void syncLayerLHSBuffer(LayerHandle id) {
   MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->begin_run();
+  if(!mm->m_lhs->needs_sync()) {
+    // constant and already resident on the accelerator
+    return;
+  }
+  // do not overwrite inputs that a queued run may still be reading
+  monitor->drain(mm);
   mm->m_lhs->host2accel();
   if(mm->has_cpu_ctx()) {
     gemmbitserial::GEMMContext ctx = mm->getCPUContext();
-    ctx.lhs.importRegular(mm->m_lhs->hostbuf());
+    ctx.lhs.importRegular(mm->m_lhs->gather_hostbuf());
   }
 }
 
 void syncLayerRHSBuffer(LayerHandle id) {
   MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->begin_run();
+  if(!mm->m_rhs->needs_sync()) {
+    // constant and already resident on the accelerator
+    return;
+  }
+  // do not overwrite inputs that a queued run may still be reading
+  monitor->drain(mm);
   mm->m_rhs->host2accel();
   if(mm->has_cpu_ctx()) {
     gemmbitserial::GEMMContext ctx = mm->getCPUContext();
-    ctx.rhs.importRegular(mm->m_rhs->hostbuf());
+    ctx.rhs.importRegular(mm->m_rhs->gather_hostbuf());
   }
 }
 
+void bindLayerLHSBuffer(LayerHandle id, const uint8_t * ptr, size_t row_stride) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  // queued runs only read the bit-serial buffers, which the next sync updates
+  mm->m_lhs->bind(ptr, row_stride);
+}
+
+void bindLayerRHSBuffer(LayerHandle id, const uint8_t * ptr, size_t col_stride) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->m_rhs->bind(ptr, col_stride);
+}
+
+uint8_t * allocSharedBuffer(size_t nbytes) {
+  return pool->alloc_shared(nbytes);
+}
+
+void freeSharedBuffer(uint8_t * ptr) {
+  pool->dealloc_shared(ptr);
+}
+
+void markLayerLHSDirty(LayerHandle id, size_t row_begin, size_t row_end) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->m_lhs->mark_dirty(row_begin, row_end);
+}
+
+void markLayerRHSDirty(LayerHandle id, size_t col_begin, size_t col_end) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->m_rhs->mark_dirty(col_begin, col_end);
+}
+
+void setLayerLHSConstant(LayerHandle id, bool is_const) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->m_lhs->set_constant(is_const);
+}
+
+void setLayerRHSConstant(LayerHandle id, bool is_const) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  mm->m_rhs->set_constant(is_const);
+}
+
 void syncLayerResBuffer(LayerHandle id) {
   MatrixMultiply * mm = (MatrixMultiply *) id;
-  mm->m_res->accel2host();
+  LayerScope scope(mm);
+  // results are only valid once the layer has finished executing
+  monitor->drain(mm);
+  mm->syncResult();
+  mm->end_run();
+}
+
+void syncLayerResRegion(
+  LayerHandle id, size_t row0, size_t nrows, size_t col0, size_t ncols
+) {
+  MatrixMultiply * mm = (MatrixMultiply *) id;
+  LayerScope scope(mm);
+  monitor->drain(mm);
+  mm->syncResult(row0, nrows, col0, ncols);
+  mm->end_run();
 }
 
 void deinitMatMul(LayerHandle id) {
   MatrixMultiply * mm = (MatrixMultiply *) id;
-  delete mm->m_lhs;
-  delete mm->m_rhs;
-  delete mm->m_res;
-  delete mm;
+  monitor->drain(mm);
+  plans->release(mm);
+}
+
+void setPlanCacheBytes(size_t nbytes) {
+  plans->set_capacity(nbytes);
 }
 
 }
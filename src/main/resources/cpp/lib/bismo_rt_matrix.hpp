@@ -66,6 +66,7 @@ public:
   ) {
     m_is_coherent = is_coherent;
     m_name = name;
+    m_counter_group = counter_group(name);
     m_matrix_type = matrix_type;
     m_rows = rows;
     m_cols = cols;
@@ -92,37 +93,51 @@ public:
     }
     const size_t outer_align = is_transposed ? cfg.dpaDimRHS : cfg.dpaDimLHS;
     const size_t inner_align = matrix_type == matTypeRes ? cfg.dpaDimLHS : cfg.dpaDimCommon;
+    m_outer_align = outer_align;
+    m_inner_align = inner_align;
     m_outer_a = gemmbitserial::alignTo(outer(), outer_align);
     m_inner_a = gemmbitserial::alignTo(inner(), inner_align);
-    // TODO support constant matrices
-    m_padded_buf = new SharedBuffer<T>(
-      elems_a(), platform, m_name+"_buf", false, is_coherent
-    );
-    m_needs_padding = (outer() != outer_a()) || (inner() != inner_a());
-    if(m_needs_padding) {
+    // stored as a single chunk unless set_inner_chunk/set_outer_chunk say
+    // otherwise
+    m_inner_chunk = m_inner_a;
+    m_outer_chunk = m_outer_a;
+    m_is_const = false;
+    m_is_synced = false;
+    m_accel_valid = false;
+    m_bound_buf = 0;
+    m_bound_stride = 0;
+    m_bound_accelbuf = 0;
+    m_is_bitserial = (matrix_type != matTypeRes);
+    // bit-serial matrices in ordinary memory are converted straight from the
+    // host buffer, padding on the fly. coherent ones are padded in place,
+    // where the p2s accelerator can read them without any copies.
+    m_direct_p2s = is_bitserial() && !is_coherent;
+    if(m_direct_p2s) {
+      m_padded_buf = 0;
+      m_needs_padding = false;
       m_unpadded_hostbuf = new T[elems()];
-      // initialize the padded buf to all zeroes
-      // using memset here throws "Bus error" so using a for-loop instead:
-      // memset(padded_hostbuf(), 0, elems_a() * sizeof(T));
-      for(size_t i = 0; i < elems_a(); i++) {
-        padded_hostbuf()[i] = 0;
-      }
     } else {
-      m_unpadded_hostbuf = 0;
+      m_padded_buf = new SharedBuffer<T>(
+        elems_a(), platform, m_name+"_buf", false, is_coherent
+      );
+      m_needs_padding = (outer() != outer_a()) || (inner() != inner_a());
+      if(m_needs_padding) {
+        m_unpadded_hostbuf = new T[elems()];
+        zero_padding();
+      } else {
+        m_unpadded_hostbuf = 0;
+      }
     }
-    m_is_bitserial = (matrix_type != matTypeRes);
     if(is_bitserial()) {
-      m_bitserial_accelbuf = (uint32_t)(uint64_t) platform->allocAccelBuffer(bitserial_nbytes());
+      m_bitserial_accelbuf = pool->alloc(bitserial_nbytes());
     }
   };
 
   ~Matrix() {
     delete m_padded_buf;
-    if(m_needs_padding) {
-      delete [] m_unpadded_hostbuf;
-    }
+    delete [] m_unpadded_hostbuf;
     if(is_bitserial()) {
-      platform->deallocAccelBuffer((void *) m_bitserial_accelbuf);
+      pool->dealloc(m_bitserial_accelbuf);
     }
   };
 
@@ -171,54 +186,303 @@ public:
     return inner_a() * outer_a();
   };
 
+  // split the inner dimension into chunks of given size (the last one may be
+  // smaller). each chunk is stored as a separate outer_a x chunk matrix in
+  // the padded and bit-serial buffers, so that it can be fetched as an
+  // independent matrix. must be called before the host buffer is used.
+  void set_inner_chunk(size_t chunk) {
+    if(chunk == 0 || chunk % m_inner_align != 0) {
+      throw "Inner chunk size must be a multiple of the inner alignment";
+    }
+    m_inner_chunk = std::min(chunk, inner_a());
+    if(m_direct_p2s) {
+      // the chunks only exist in the bit-serial buffer
+      return;
+    }
+    if(num_inner_chunks() > 1 && !m_needs_padding) {
+      // host-side layout now differs from the padded one
+      m_needs_padding = true;
+      m_unpadded_hostbuf = new T[elems()];
+    }
+    // the padding moved along with the chunks
+    zero_padding();
+  };
+
+  const size_t inner_chunk() const {
+    return m_inner_chunk;
+  };
+
+  const size_t num_inner_chunks() const {
+    return (inner_a() + m_inner_chunk - 1) / m_inner_chunk;
+  };
+
+  // aligned inner size of given chunk
+  const size_t inner_chunk_a(size_t c) const {
+    return std::min(m_inner_chunk, inner_a() - c * m_inner_chunk);
+  };
+
+  // split the outer dimension of the bit-serial buffer into chunks of given
+  // size (the last one may be smaller). each outer chunk is stored as a
+  // separate chunk x inner_a matrix, itself split into inner chunks, so that
+  // it can be fetched as an independent matrix. the host and padded buffers
+  // are not affected. must be called before the first host2accel.
+  void set_outer_chunk(size_t chunk) {
+    if(!is_bitserial()) {
+      throw "Only bit-serial matrices can be split into outer chunks";
+    }
+    if(chunk == 0 || chunk % m_outer_align != 0) {
+      throw "Outer chunk size must be a multiple of the outer alignment";
+    }
+    m_outer_chunk = std::min(chunk, outer_a());
+    invalidate();
+  };
+
+  const size_t outer_chunk() const {
+    return m_outer_chunk;
+  };
+
+  const size_t num_outer_chunks() const {
+    return (outer_a() + m_outer_chunk - 1) / m_outer_chunk;
+  };
+
+  // aligned outer size of given chunk
+  const size_t outer_chunk_a(size_t o) const {
+    return std::min(m_outer_chunk, outer_a() - o * m_outer_chunk);
+  };
+
   // copy accel buffer to host buffer
   void accel2host() {
-    TIMER_SAMPLE();
-    m_padded_buf->accel2host();
-    TIMER_SAMPLE();
-    TIMER_REPORT(m_name + "_accel2host");
-    TIMER_SAMPLE();
+    PhaseTimer t_copy(counter(phaseAccel2Host));
+    padded_buf()->accel2host();
+    t_copy.stop();
+    PhaseTimer t_unpad(counter(phaseUnpad));
     if(m_needs_padding) {
       // strided copy into m_unpadded_hostbuf
-      copy2d(
-        m_padded_buf->hostbuf(), m_unpadded_hostbuf,
-        outer_a(), inner_a(), outer(), inner()
-      );
-      // TODO time measurement for un-padding
+      copy_padded(false);
     }
-    TIMER_SAMPLE();
-    TIMER_REPORT(m_name + "_unpad");
   };
 
-  // copy host buffer to accel buffer
-  void host2accel() {
-    TIMER_SAMPLE();
+  // copy only outer rows [outer_begin, outer_end) and inner columns
+  // [inner_begin, inner_end) from the accel buffer to the host buffer, e.g.
+  // a few columns or rows of a result. the rest of the host buffer keeps its
+  // previous contents.
+  void accel2host(
+    size_t outer_begin, size_t outer_end, size_t inner_begin, size_t inner_end
+  ) {
+    if(outer_begin >= outer_end || outer_end > outer() ||
+       inner_begin >= inner_end || inner_end > inner()) {
+      throw "Invalid region for matrix";
+    }
+    const size_t n_outer = outer_end - outer_begin;
+    // the region is copied separately from each inner chunk it overlaps
+    const size_t c_begin = inner_begin / m_inner_chunk;
+    const size_t c_end = (inner_end - 1) / m_inner_chunk + 1;
+    PhaseTimer t_copy(counter(phaseAccel2Host));
+    for(size_t c = c_begin; c < c_end; c++) {
+      const size_t start = c * m_inner_chunk;
+      const size_t chunk_a = inner_chunk_a(c);
+      const size_t lo = std::max(inner_begin, start) - start;
+      const size_t n_inner = std::min(inner_end, start + chunk_a) - start - lo;
+      const size_t base = outer_a() * start;
+      if(2 * n_inner >= chunk_a) {
+        // most of each row is needed, one contiguous copy is cheaper
+        padded_buf()->accel2host(base + outer_begin * chunk_a, n_outer * chunk_a);
+      } else {
+        for(size_t o = outer_begin; o < outer_end; o++) {
+          padded_buf()->accel2host(base + o * chunk_a + lo, n_inner);
+        }
+      }
+    }
+    t_copy.stop();
+    PhaseTimer t_unpad(counter(phaseUnpad));
     if(m_needs_padding) {
-      // strided copy from m_unpadded_hostbuf
-      copy2d(
-        m_unpadded_hostbuf, m_padded_buf->hostbuf(),
-        outer(), inner(), outer_a(), inner_a()
+      for(size_t c = c_begin; c < c_end; c++) {
+        const size_t start = c * m_inner_chunk;
+        const size_t chunk_a = inner_chunk_a(c);
+        const size_t lo = std::max(inner_begin, start) - start;
+        const size_t n_inner = std::min(inner_end, start + chunk_a) - start - lo;
+        copy2d_strided(
+          padded_hostbuf() + outer_a() * start + outer_begin * chunk_a + lo,
+          m_unpadded_hostbuf + outer_begin * inner() + start + lo,
+          n_outer, n_inner, chunk_a, inner(), m_is_coherent
+        );
+      }
+    }
+  };
+
+  // constant matrices are only transferred (and converted to bit-serial) on
+  // the first host2accel call, later calls do nothing. setting the constant
+  // flag again forces one more transfer, e.g. to load new weights.
+  void set_constant(bool is_const) {
+    m_is_const = is_const;
+    m_is_synced = false;
+  };
+
+  const bool is_constant() const {
+    return m_is_const;
+  };
+
+  // whether host2accel would do anything
+  const bool needs_sync() const {
+    return !(m_is_const && m_is_synced) || !m_dirty.empty();
+  };
+
+  // restrict the next host2accel to the outer rows [begin, end), i.e. rows
+  // of the LHS or columns of the RHS. can be called several times to add
+  // more ranges, which are widened to the DPA alignment. without any marked
+  // range host2accel converts the whole matrix, and the first host2accel
+  // always does.
+  void mark_dirty(size_t begin, size_t end) {
+    if(begin >= end || end > outer()) {
+      throw "Invalid dirty range for matrix";
+    }
+    begin = (begin / m_outer_align) * m_outer_align;
+    end = gemmbitserial::alignTo(end, m_outer_align);
+    // keep the ranges sorted and merge overlapping or adjacent ones
+    auto it = m_dirty.begin();
+    while(it != m_dirty.end() && it->second < begin) {
+      it++;
+    }
+    while(it != m_dirty.end() && it->first <= end) {
+      begin = std::min(begin, it->first);
+      end = std::max(end, it->second);
+      it = m_dirty.erase(it);
+    }
+    m_dirty.insert(it, std::make_pair(begin, end));
+  };
+
+  // forget what is in the accel buffers, so that the next host2accel
+  // converts the whole matrix
+  void invalidate() {
+    m_accel_valid = false;
+    m_dirty.clear();
+  };
+
+  // read the matrix from caller-owned memory instead of the host buffer on
+  // every host2accel, outer row o starting at ptr + o * stride (stride 0 for
+  // densely packed rows). the memory must stay valid while bound, ptr = 0
+  // goes back to the host buffer. the next host2accel converts everything.
+  void bind(const T * ptr, size_t stride) {
+    if(!is_bitserial()) {
+      throw "Only bit-serial matrices can read from caller memory";
+    }
+    if(stride == 0) {
+      stride = inner();
+    }
+    if(ptr && stride < inner()) {
+      throw "Row stride of bound buffer is smaller than the row";
+    }
+    m_bound_buf = ptr;
+    m_bound_stride = stride;
+    m_bound_accelbuf = 0;
+    if(ptr && !m_direct_p2s && !m_needs_padding && stride == inner_a()) {
+      // already in the padded layout, if the accelerator can see it too
+      // the p2s reads it in place
+      m_bound_accelbuf = pool->shared_accelbuf(
+        (const uint8_t *) ptr, elems_a() * sizeof(T)
       );
-      // TODO time measurement for padding
-    }
-    TIMER_SAMPLE();
-    TIMER_REPORT(m_name + "_pad");
-    TIMER_SAMPLE();
-    m_padded_buf->host2accel();
-    TIMER_SAMPLE();
-    TIMER_REPORT(m_name + "_host2accel");
-    TIMER_SAMPLE();
+    }
+    m_is_synced = false;
+    invalidate();
+  };
+
+  const bool is_bound() const {
+    return m_bound_buf != 0;
+  };
+
+  // the host buffer with the current contents of the matrix, gathered from
+  // the bound caller memory if there is one
+  T * gather_hostbuf() {
+    if(m_bound_buf && m_bound_buf != hostbuf()) {
+      copy2d_strided(
+        m_bound_buf, hostbuf(), outer(), inner(), m_bound_stride, inner(),
+        m_is_coherent
+      );
+    }
+    return hostbuf();
+  };
+
+  // copy host buffer to accel buffer, only the dirty ranges if any
+  void host2accel() {
+    if(!needs_sync()) {
+      return;
+    }
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if(m_accel_valid && !m_dirty.empty()) {
+      ranges = m_dirty;
+    } else {
+      ranges.push_back(std::make_pair(0, outer_a()));
+    }
+    const bool full = (ranges[0].first == 0 && ranges[0].second == outer_a());
+    size_t range_elems = 0;
+    for(auto & r : ranges) {
+      range_elems += (r.second - r.first) * inner_a();
+    }
+    PhaseTimer t_pad(counter(phasePad));
+    if(m_bound_buf ? !m_bound_accelbuf && !m_direct_p2s : m_needs_padding) {
+      // strided copy from m_unpadded_hostbuf or the bound caller memory
+      for(auto & r : ranges) {
+        copy_padded(true, r.first, r.second);
+      }
+    }
+    t_pad.stop();
+    // the software p2s reads the padded host buffer, which is uncached
+    // accelerator memory for coherent matrices, so keep those on the HW p2s
+    P2SBackend backend = p2sBackendHW;
+    if(is_bitserial() && !m_is_coherent) {
+      backend = p2s_choose_backend(range_elems);
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    PhaseTimer t_copy(counter(phaseHost2Accel));
+    if(backend == p2sBackendHW && !m_direct_p2s) {
+      // only the HW p2s of a padded buffer reads the bit-parallel accel
+      // buffer, the direct one stages its rows itself
+      if(full) {
+        m_padded_buf->host2accel();
+      } else {
+        // the rows of a range are contiguous within each inner chunk
+        for(auto & r : ranges) {
+          for(size_t c = 0; c < num_inner_chunks(); c++) {
+            const size_t chunk_a = inner_chunk_a(c);
+            m_padded_buf->host2accel(
+              outer_a() * c * m_inner_chunk + r.first * chunk_a,
+              (r.second - r.first) * chunk_a
+            );
+          }
+        }
+      }
+    }
+    t_copy.stop();
+    float us = us_since(t0);
+    PhaseTimer t_p2s(counter(phaseP2S));
     if(is_bitserial()) {
-      // TODO call only once for const matrices
-      p2s();
+      if(backend == p2sBackendSW) {
+        t0 = std::chrono::steady_clock::now();
+        for(auto & r : ranges) {
+          p2s_cpu(r.first, r.second);
+        }
+      } else {
+        // p2s shares the DRAM port with the matmul stages, so any in-flight
+        // matmul must finish first. the wait does not count towards the
+        // p2s cost.
+        std::unique_lock<std::mutex> accel_lock = monitor->lock_idle();
+        t0 = std::chrono::steady_clock::now();
+        for(auto & r : ranges) {
+          p2s(r.first, r.second);
+        }
+      }
+      p2s_record(backend, range_elems, us + us_since(t0));
+      record_counter(counter(phaseP2SSW), (backend == p2sBackendSW) ? 1 : 0);
     }
-    TIMER_SAMPLE();
-    TIMER_REPORT(m_name + "_p2s");
+    t_p2s.stop();
+    m_dirty.clear();
+    m_is_synced = true;
+    m_accel_valid = true;
   };
 
   // get a host-accessible pointer to the host buffer
   T * hostbuf() {
-    if(m_needs_padding) {
+    if(m_unpadded_hostbuf) {
       return m_unpadded_hostbuf;
     } else {
       return m_padded_buf->hostbuf();
@@ -227,14 +491,20 @@ public:
 
   // get a host-accessible pointer to the padded host buffer
   T * padded_hostbuf() {
-    return m_padded_buf->hostbuf();
+    return padded_buf()->hostbuf();
   };
 
   // get an accel-accessible pointer to the bit-parallel accel buffer
   uint32_t accelbuf() {
-    return m_padded_buf->accelbuf();
+    return padded_buf()->accelbuf();
   };
 
+  // accelerator memory used by this matrix, in bytes
+  size_t accel_nbytes() const {
+    return (m_padded_buf ? m_padded_buf->nbytes() : 0) +
+      (is_bitserial() ? bitserial_nbytes() : 0);
+  }
+
   uint32_t bitserial_accelbuf() {
     if(is_bitserial()) {
       return m_bitserial_accelbuf;
@@ -243,6 +513,13 @@ public:
     }
   }
 
+  // bit-serial accel buffer for given outer and inner chunk
+  uint32_t bitserial_accelbuf(size_t o, size_t c) {
+    const size_t elems_before = o * m_outer_chunk * inner_a() +
+      outer_chunk_a(o) * c * m_inner_chunk;
+    return bitserial_accelbuf() + (m_bits * elems_before) / 8;
+  }
+
   size_t bitserial_nbytes() const {
     if(is_bitserial()) {
       return (m_bits * elems_a()) / 8;
@@ -255,56 +532,247 @@ public:
     return sizeof(T);
   }
 
-  // convert the accelerator bit-parallel buffer to bit-serial
+  // convert to bit-serial on the p2s accelerator, either straight from the
+  // host buffer or from the padded bit-parallel accel buffer. the caller
+  // must own the idle accelerator, see CompletionMonitor::lock_idle
   uint32_t p2s() {
+    return p2s(0, outer_a());
+  }
+
+  // as above, but only for outer rows [begin, end). the other rows of each
+  // bit plane are left as they are.
+  uint32_t p2s(size_t begin, size_t end) {
     if(!m_is_bitserial) {
       throw "Unsupported matrix type for parallel-to-serial conversion.";
     }
-    // setup and call the p2s hardware accelerator
-    acc->setup_p2s(
-      (void *) accelbuf(),  // source buffer
-      bitserial_nbytes(),   // num bytes to be written to dest
-      (void *) bitserial_accelbuf(),  // dest buffer
-      outer_a(), inner_a(), bits(),   // dimensions
-      is_signed()
-    );
-    uint32_t cycles = acc->p2s_exec_and_wait();
+    uint32_t cycles = 0;
+    // rows are converted separately for each outer chunk they fall into
+    for(size_t o = begin / m_outer_chunk; o * m_outer_chunk < end; o++) {
+      const size_t o_begin = std::max(begin, o * m_outer_chunk);
+      const size_t o_end = std::min(end, o * m_outer_chunk + outer_chunk_a(o));
+      const size_t nrows = o_end - o_begin;
+      // first row within the outer chunk
+      const size_t local = o_begin - o * m_outer_chunk;
+      for(size_t c = 0; c < num_inner_chunks(); c++) {
+        const size_t chunk_a = inner_chunk_a(c);
+        const uint32_t dst = bitserial_accelbuf(o, c) + (local * chunk_a) / 8;
+        const size_t plane_stride = (outer_chunk_a(o) * chunk_a) / 8;
+        if(m_direct_p2s) {
+          const size_t start = c * m_inner_chunk;
+          cycles += p2s_hw(
+            (const uint8_t *) (src_buf() + o_begin * src_stride() + start),
+            src_stride(), rows_present(o_begin, o_end), std::min(chunk_a, inner() - start),
+            dst, nrows, chunk_a, plane_stride, bits(), is_signed()
+          );
+          continue;
+        }
+        // bound caller memory in the accelerator is only used in place when
+        // it has the padded layout, see bind
+        const uint32_t src = m_bound_accelbuf ? m_bound_accelbuf : accelbuf();
+        // setup and call the p2s hardware accelerator
+        acc->setup_p2s(
+          (void *) (src + (outer_a() * c * m_inner_chunk + o_begin * chunk_a) * sizeof(T)),
+          (bits() * nrows * chunk_a) / 8,       // num bytes to be written to dest
+          (void *) dst,                         // dest buffer
+          nrows, chunk_a, bits(),               // dimensions
+          is_signed(),
+          plane_stride                          // dest bit plane stride
+        );
+        cycles += acc->p2s_exec_and_wait();
+      }
+    }
     return cycles;
   }
 
+  // convert the host buffer to bit-serial on the CPU and copy the result
+  // into the bit-serial accel buffer
+  void p2s_cpu() {
+    p2s_cpu(0, outer_a());
+  }
+
+  // as above, but only for outer rows [begin, end)
+  void p2s_cpu(size_t begin, size_t end) {
+    if(!m_is_bitserial) {
+      throw "Unsupported matrix type for parallel-to-serial conversion.";
+    }
+    // rows are converted separately for each outer chunk they fall into
+    for(size_t o = begin / m_outer_chunk; o * m_outer_chunk < end; o++) {
+      const size_t o_begin = std::max(begin, o * m_outer_chunk);
+      const size_t o_end = std::min(end, o * m_outer_chunk + outer_chunk_a(o));
+      const size_t nrows = o_end - o_begin;
+      // first row within the outer chunk
+      const size_t local = o_begin - o * m_outer_chunk;
+      for(size_t c = 0; c < num_inner_chunks(); c++) {
+        const size_t chunk_a = inner_chunk_a(c);
+        const size_t nbytes = (bits() * nrows * chunk_a) / 8;
+        uint64_t * host_bitser = (uint64_t *) staging()->get(nbytes);
+        if(m_direct_p2s) {
+          // pad on the fly while reading the unpadded rows
+          const size_t start = c * m_inner_chunk;
+          bismo_rt::p2s_sw(
+            (const uint8_t *) (src_buf() + o_begin * src_stride() + start),
+            src_stride(), rows_present(o_begin, o_end), std::min(chunk_a, inner() - start),
+            host_bitser, nrows, chunk_a,
+            bits(), is_signed()
+          );
+        } else {
+          bismo_rt::p2s_sw(
+            (const uint8_t *) (padded_hostbuf() + outer_a() * c * m_inner_chunk + o_begin * chunk_a),
+            chunk_a, nrows, chunk_a,              // source stride and dims
+            host_bitser, nrows, chunk_a,          // destination dims
+            bits(), is_signed()
+          );
+        }
+        if(nrows == outer_chunk_a(o)) {
+          platform->copyBufferHostToAccel(
+            (void *) host_bitser, (void *) bitserial_accelbuf(o, c), nbytes
+          );
+        } else {
+          // each bit plane goes to its own part of the destination
+          const size_t nbytes_plane = (nrows * chunk_a) / 8;
+          for(size_t b = 0; b < bits(); b++) {
+            platform->copyBufferHostToAccel(
+              (void *) ((uint8_t *) host_bitser + b * nbytes_plane),
+              (void *) (bitserial_accelbuf(o, c) + (b * outer_chunk_a(o) + local) * chunk_a / 8),
+              nbytes_plane
+            );
+          }
+        }
+      }
+    }
+  }
+
+  // instrumentation counter for given phase of this matrix
+  size_t counter(MatrixPhase phase) const {
+    return matrix_counter(m_counter_group, phase);
+  };
+
   // two-dimensional memory copy between arrays of different
-  // dimensions, useful for padding and un-padding
+  // dimensions, useful for padding and un-padding. set device if either
+  // array may be a coherent/uncached mapping, see copy_mem.
   static void copy2d(
     T * src, T * dst, // source and destination host buffers
     size_t src_n_outer, size_t src_n_inner, // source dims
-    size_t dst_n_outer, size_t dst_n_inner  // destination dims
+    size_t dst_n_outer, size_t dst_n_inner, // destination dims
+    bool device = false
   ) {
-    const size_t min_outer = std::min(src_n_outer, dst_n_outer);
-    const size_t min_inner = std::min(src_n_inner, dst_n_inner);
-    for(size_t o = 0; o < min_outer; o++) {
-      // using memcpy here can cause bus errors with coherency enabled,
-      // so opting for a secondary for-loop instead
-      // memcpy(dst, src, sizeof(T) * min_inner);
-      for(size_t i = 0; i < min_inner; i++) {
-        dst[i] = src[i];
-      }
-      dst += dst_n_inner;
-      src += src_n_inner;
+    copy2d_strided(
+      src, dst,
+      std::min(src_n_outer, dst_n_outer), std::min(src_n_inner, dst_n_inner),
+      src_n_inner, dst_n_inner, device
+    );
+  };
+
+  // copy n_outer x n_inner elements between arrays with given row strides
+  static void copy2d_strided(
+    const T * src, T * dst, // source and destination host buffers
+    size_t n_outer, size_t n_inner, // dims of the copied region
+    size_t src_stride, size_t dst_stride, // elements per row
+    bool device = false
+  ) {
+    for(size_t o = 0; o < n_outer; o++) {
+      copy_mem(dst, src, sizeof(T) * n_inner, device);
+      dst += dst_stride;
+      src += src_stride;
     }
   };
 
 protected:
+  SharedBuffer<T> * padded_buf() {
+    if(!m_padded_buf) {
+      throw "Matrix has no padded buffer, it is converted straight to bit-serial";
+    }
+    return m_padded_buf;
+  };
+
+  // where the unpadded matrix is read from: the bound caller memory or the
+  // host buffer, and the elements between two outer rows there
+  const T * src_buf() const {
+    return m_bound_buf ? m_bound_buf : m_unpadded_hostbuf;
+  };
+
+  size_t src_stride() const {
+    return m_bound_buf ? m_bound_stride : inner();
+  };
+
+  // number of outer rows in [begin, end) that are part of the matrix, the
+  // rest is padding
+  size_t rows_present(size_t begin, size_t end) const {
+    return (begin < outer()) ? std::min(end, outer()) - begin : 0;
+  };
+
+  // pad (to_padded = true) or un-pad between the host buffer and the padded
+  // buffer, taking the inner chunk layout of the padded buffer into account
+  void copy_padded(bool to_padded) {
+    copy_padded(to_padded, 0, outer());
+  };
+
+  // as above, but only for outer rows [begin, end)
+  void copy_padded(bool to_padded, size_t begin, size_t end) {
+    end = std::min(end, outer());
+    if(begin >= end) {
+      return;
+    }
+    for(size_t c = 0; c < num_inner_chunks(); c++) {
+      const size_t start = c * m_inner_chunk;
+      const size_t chunk_a = inner_chunk_a(c);
+      T * padded = m_padded_buf->hostbuf() + outer_a() * start + begin * chunk_a;
+      const size_t n_inner = std::min(chunk_a, inner() - start);
+      if(to_padded) {
+        copy2d_strided(
+          src_buf() + begin * src_stride() + start, padded, end - begin,
+          n_inner, src_stride(), chunk_a, m_is_coherent
+        );
+      } else {
+        T * unpadded = m_unpadded_hostbuf + begin * inner() + start;
+        copy2d_strided(padded, unpadded, end - begin, n_inner, chunk_a, inner(), m_is_coherent);
+      }
+    }
+  };
+
+  // zero the parts of the padded buffer outside the matrix, taking the inner
+  // chunk layout into account. padding never writes there.
+  void zero_padding() {
+    for(size_t c = 0; c < num_inner_chunks(); c++) {
+      const size_t start = c * m_inner_chunk;
+      const size_t chunk_a = inner_chunk_a(c);
+      const size_t n_inner = std::min(chunk_a, inner() - start);
+      T * padded = m_padded_buf->hostbuf() + outer_a() * start;
+      // end of each row, then the rows below the matrix
+      if(n_inner < chunk_a) {
+        for(size_t o = 0; o < outer(); o++) {
+          zero_mem(padded + o * chunk_a + n_inner, (chunk_a - n_inner) * sizeof(T), m_is_coherent);
+        }
+      }
+      zero_mem(padded + outer() * chunk_a, (outer_a() - outer()) * chunk_a * sizeof(T), m_is_coherent);
+    }
+  };
+
   bool m_needs_padding;
+  bool m_direct_p2s;
   uint32_t m_bitserial_accelbuf;
   SharedBuffer<T> * m_padded_buf;
   T * m_unpadded_hostbuf;
   size_t m_rows, m_cols, m_bits;
-  size_t m_inner_a, m_outer_a;
+  size_t m_inner_a, m_outer_a, m_outer_align, m_inner_align;
+  size_t m_inner_chunk, m_outer_chunk;
   bool m_is_signed;
+  bool m_is_const;
+  bool m_is_synced;
+  // whether the accel buffers hold a full conversion of the matrix, and the
+  // sorted outer row ranges that changed since then
+  bool m_accel_valid;
+  std::vector<std::pair<size_t, size_t>> m_dirty;
+  // caller memory bound by bind, and its accelerator address if the p2s
+  // can read it in place
+  const T * m_bound_buf;
+  size_t m_bound_stride;
+  uint32_t m_bound_accelbuf;
   bool m_is_transposed;
   bool m_is_bitserial;
   MatrixType m_matrix_type;
   std::string m_name;
+  CounterGroup m_counter_group;
   bool m_is_coherent;
 };
 
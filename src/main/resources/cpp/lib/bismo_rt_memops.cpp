@@ -0,0 +1,134 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_internal.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace bismo_rt {
+
+// device (uncached or coherent) mappings fault on unaligned accesses and on
+// cache maintenance tricks such as DC ZVA, which memcpy/memset may use. the
+// kernels below only use naturally aligned 16-byte vector accesses, aligned
+// 8-byte scalar ones if source and destination are not 16-byte aligned to
+// each other, and single bytes for the unaligned head and tail. the scalar
+// accesses go through volatile pointers so that the compiler cannot turn the
+// loops back into memcpy/memset calls.
+
+static inline size_t misalign(const void * p, size_t align) {
+  return (uintptr_t) p & (align - 1);
+}
+
+static inline void copy_bytes(uint8_t * & dst, const uint8_t * & src, size_t n) {
+  for(size_t i = 0; i < n; i++) {
+    *(volatile uint8_t *) dst++ = *(const volatile uint8_t *) src++;
+  }
+}
+
+static void copy_device(uint8_t * dst, const uint8_t * src, size_t nbytes) {
+  if(misalign(dst, 16) == misalign(src, 16)) {
+    const size_t head = std::min(nbytes, (16 - misalign(dst, 16)) % 16);
+    copy_bytes(dst, src, head);
+    nbytes -= head;
+    for(; nbytes >= 16; nbytes -= 16, dst += 16, src += 16) {
+#if defined(__SSE2__)
+      _mm_store_si128((__m128i *) dst, _mm_load_si128((const __m128i *) src));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+      vst1q_u64((uint64_t *) dst, vld1q_u64((const uint64_t *) src));
+#else
+      ((volatile uint64_t *) dst)[0] = ((const volatile uint64_t *) src)[0];
+      ((volatile uint64_t *) dst)[1] = ((const volatile uint64_t *) src)[1];
+#endif
+    }
+  } else if(misalign(dst, 8) == misalign(src, 8)) {
+    const size_t head = std::min(nbytes, (8 - misalign(dst, 8)) % 8);
+    copy_bytes(dst, src, head);
+    nbytes -= head;
+    for(; nbytes >= 8; nbytes -= 8, dst += 8, src += 8) {
+      *(volatile uint64_t *) dst = *(const volatile uint64_t *) src;
+    }
+  } else if(misalign(dst, 4) == misalign(src, 4)) {
+    const size_t head = std::min(nbytes, (4 - misalign(dst, 4)) % 4);
+    copy_bytes(dst, src, head);
+    nbytes -= head;
+    for(; nbytes >= 4; nbytes -= 4, dst += 4, src += 4) {
+      *(volatile uint32_t *) dst = *(const volatile uint32_t *) src;
+    }
+  }
+  copy_bytes(dst, src, nbytes);
+}
+
+static void zero_device(uint8_t * dst, size_t nbytes) {
+  const size_t head = std::min(nbytes, (16 - misalign(dst, 16)) % 16);
+  for(size_t i = 0; i < head; i++) {
+    *(volatile uint8_t *) dst++ = 0;
+  }
+  nbytes -= head;
+#if defined(__SSE2__)
+  const __m128i z = _mm_setzero_si128();
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint64x2_t z = vdupq_n_u64(0);
+#endif
+  for(; nbytes >= 16; nbytes -= 16, dst += 16) {
+#if defined(__SSE2__)
+    _mm_store_si128((__m128i *) dst, z);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    vst1q_u64((uint64_t *) dst, z);
+#else
+    ((volatile uint64_t *) dst)[0] = 0;
+    ((volatile uint64_t *) dst)[1] = 0;
+#endif
+  }
+  for(size_t i = 0; i < nbytes; i++) {
+    *(volatile uint8_t *) dst++ = 0;
+  }
+}
+
+void copy_mem(void * dst, const void * src, size_t nbytes, bool device) {
+  if(device) {
+    copy_device((uint8_t *) dst, (const uint8_t *) src, nbytes);
+  } else {
+    memcpy(dst, src, nbytes);
+  }
+}
+
+void zero_mem(void * dst, size_t nbytes, bool device) {
+  if(device) {
+    zero_device((uint8_t *) dst, nbytes);
+  } else {
+    memset(dst, 0, nbytes);
+  }
+}
+
+}
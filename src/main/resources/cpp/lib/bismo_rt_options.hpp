@@ -31,11 +31,54 @@
 
 // enable to print debug info
 //#define DEBUG
-// enable instrumentation for detailed measurements
+// enable instrumentation for detailed measurements, and the level it starts
+// at (see setInstrumentationLevel). off by default, so that nothing is
+// recorded unless an application asks for it.
 #define BISMORT_INSTRUMENTATION
+#define BISMORT_INSTRUMENTATION_LEVEL   instrOff
 //#define BISMORT_INSTRUMENTATION_VERBOSE
 // enable to compare hw-produced results against sw-produced ones
 //#define BISMORT_MATMUL_VERIFY_AGAINST_CPU
 // number of bytes for the p2s bit-parallel buffer on the accelerator side
 #define BISMORT_P2S_BITPAR_BYTES  (1024*1024)
+// enable to always use the software p2s instead of choosing per call
 //#define BISMORT_USE_SW_P2S
+// enable to generate the accelerator instructions on the host by default,
+// see setInstrGenSource
+//#define BISMORT_USE_HOST_INSTRGEN
+// number of threads for the software p2s (0 = one per CPU core), and the
+// smallest bit-parallel matrix in bytes that is worth splitting across threads.
+// the calling thread is one of them, the others are created on first use and
+// shared by all callers.
+#define BISMORT_SW_P2S_THREADS      0
+#define BISMORT_SW_P2S_MT_MIN_BYTES (256*1024)
+// p2s cost model: weight kept for older samples on each new one, and how
+// often (in calls) the backend predicted to be slower is measured again
+#define BISMORT_P2S_MODEL_DECAY     0.9
+#define BISMORT_P2S_MODEL_EXPLORE   64
+// adaptive polling when waiting for the accelerator to finish: busy-poll for
+// this many iterations, then yield for this many, then sleep with exponential
+// backoff capped at BISMORT_POLL_MAX_SLEEP_US microseconds
+#define BISMORT_POLL_SPIN_ITERS     64
+#define BISMORT_POLL_YIELD_ITERS    64
+#define BISMORT_POLL_MAX_SLEEP_US   256
+// max number of descriptors (one per K chunk of a matrix multiply) queued on
+// the accelerator at the same time, should not exceed the descriptor queue depth (dscQueueEntries) in hardware
+#define BISMORT_MAX_INFLIGHT_DSC    4
+// how often the 32-bit hardware performance counters are read while layers
+// are in flight, must stay below their wrap time (2^32 cycles)
+#define BISMORT_PERF_REFRESH_MS     1000
+// max accelerator bytes held by layers kept for reuse after deinitMatMul,
+// see setPlanCacheBytes
+#define BISMORT_PLAN_CACHE_BYTES    (16*1024*1024)
+// smallest size class for the accelerator buffer pool, in bytes
+#define BISMORT_ACCEL_POOL_MIN_BYTES  4096
+// max bytes the accelerator buffer pool keeps in its free lists, the buffers
+// freed the longest time ago are given back to the platform beyond that
+#define BISMORT_ACCEL_POOL_MAX_FREE_BYTES (32*1024*1024)
+// number of events kept by the tracer (see setTracing), and the min interval
+// between samples of the accelerator stage counters while tracing
+#define BISMORT_TRACE_EVENTS        (1 << 16)
+#define BISMORT_TRACE_SAMPLE_US     100
+// alignment for host-side staging buffers
+#define BISMORT_CACHELINE_BYTES       64
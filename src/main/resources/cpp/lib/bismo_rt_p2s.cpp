@@ -32,14 +32,107 @@
 #include "bismo_rt_internal.hpp"
 #include "gemmbitserial/test/testhelpers.hpp"
 #include <string>
+#include <atomic>
 namespace bismo_rt {
 uint32_t accel_p2s_bitpar_buffer;
-uint8_t * host_p2s_bitpar_buffer;
 
-// hardware-accelerated 8-bit-parallel to bit-serial conversion
+StagingArena * staging() {
+  // allocated on first use, freed when the thread exits
+  static thread_local StagingArena arena(0);
+  return &arena;
+}
+
+// linear model of the p2s time, us = fixed + per_byte * nbytes, fitted by
+// least squares over the measured calls with older samples decaying
+class P2SCostModel {
+public:
+  P2SCostModel() : m_n(0), m_w(0), m_x(0), m_y(0), m_xx(0), m_xy(0) {};
+
+  void record(double nbytes, double us) {
+    const double d = BISMORT_P2S_MODEL_DECAY;
+    m_w = d * m_w + 1;
+    m_x = d * m_x + nbytes;
+    m_y = d * m_y + us;
+    m_xx = d * m_xx + nbytes * nbytes;
+    m_xy = d * m_xy + nbytes * us;
+    m_n++;
+  };
+
+  // need two samples for a line, otherwise no prediction
+  bool valid() const {
+    return m_n >= 2;
+  };
+
+  double predict(double nbytes) const {
+    const double den = m_w * m_xx - m_x * m_x;
+    if(den > 1e-6 * m_w * m_xx) {
+      const double per_byte = (m_w * m_xy - m_x * m_y) / den;
+      const double fixed = (m_y - per_byte * m_x) / m_w;
+      if(per_byte >= 0 && fixed >= 0) {
+        return fixed + per_byte * nbytes;
+      }
+    }
+    // all samples of about the same size or noisy fit, scale the average
+    return (m_x > 0) ? (m_y / m_x) * nbytes : m_y / m_w;
+  };
+
+protected:
+  size_t m_n;
+  double m_w, m_x, m_y, m_xx, m_xy;
+};
+
+#ifdef BISMORT_USE_SW_P2S
+static std::atomic<P2SBackend> p2s_backend(p2sBackendSW);
+#else
+static std::atomic<P2SBackend> p2s_backend(p2sBackendAuto);
+#endif
+// guards the cost models, which are shared by all threads
+static std::mutex p2s_model_lock;
+static P2SCostModel p2s_cost_hw, p2s_cost_sw;
+static size_t p2s_ncalls = 0;
+
+void setP2SBackend(P2SBackend backend) {
+  p2s_backend = backend;
+}
+
+P2SBackend getP2SBackend() {
+  return p2s_backend;
+}
+
+P2SBackend p2s_choose_backend(size_t nbytes) {
+  const P2SBackend backend = p2s_backend;
+  if(backend != p2sBackendAuto) {
+    return backend;
+  }
+  std::lock_guard<std::mutex> lock(p2s_model_lock);
+  // measure each backend a couple of times before trusting the model
+  if(!p2s_cost_hw.valid()) {
+    return p2sBackendHW;
+  }
+  if(!p2s_cost_sw.valid()) {
+    return p2sBackendSW;
+  }
+  const bool sw_faster = p2s_cost_sw.predict(nbytes) < p2s_cost_hw.predict(nbytes);
+  // occasionally re-measure the slower one, its cost may have changed
+  // (e.g. other processes on the CPU)
+  const bool explore = (++p2s_ncalls % BISMORT_P2S_MODEL_EXPLORE) == 0;
+  return (sw_faster != explore) ? p2sBackendSW : p2sBackendHW;
+}
+
+void p2s_record(P2SBackend backend, size_t nbytes, float us) {
+  std::lock_guard<std::mutex> lock(p2s_model_lock);
+  if(backend == p2sBackendSW) {
+    p2s_cost_sw.record(nbytes, us);
+  } else {
+    p2s_cost_hw.record(nbytes, us);
+  }
+}
+
+// 8-bit-parallel to bit-serial conversion, either on the p2s accelerator or
+// on the CPU, see p2s_choose_backend.
 // the 8-bit is only the container datatype, can specify a smaller number
 // of actual bits for the conversion
-void p2s(
+uint32_t p2s(
   const uint8_t * host_buf_src,   // input matrix buffer (source)
   uint32_t accel_buf_dst,         // output matrix buffer (destination)
   size_t nrows, size_t ncols,     // matrix size
@@ -48,61 +141,114 @@ void p2s(
   bool zeropad,                   // use zero instead of random padding
   size_t row_align                // align rows to multiple of this
 ) {
-#ifdef BISMORT_USE_SW_P2S
-  // use gemmbitserial to do CPU import
-  gemmbitserial::BitSerialMatrix mat = gemmbitserial::BitSerialMatrix::alloc(
-    nbits, nrows, ncols, issigned, cfg.dpaDimRHS, cfg.dpaDimCommon
-  );
-  size_t nbytes_bitpar_aligned = nbits * mat.wordsPerBitplane() * sizeof(PackedBitGroupType);
-  memset(mat.data, 0, nbytes_bitpar_aligned);
-  mat.importRegular(host_buf_src);
-  platform->copyBufferHostToAccel((void *)mat.data, (void *)accel_buf_dst, nbytes_bitpar_aligned);
-#else
-  // the p2s accelerator requires an aligned number of columns and rows
+  // the bit-serial layout requires an aligned number of columns and rows
   size_t ncols_a = gemmbitserial::alignTo(ncols, cfg.dpaDimCommon);
   size_t nrows_a = gemmbitserial::alignTo(nrows, row_align);
+  const P2SBackend backend = p2s_choose_backend(nrows_a * ncols_a);
+  if(backend == p2sBackendSW) {
+    auto t0 = std::chrono::steady_clock::now();
+    // padding is always zero here
+    const size_t nbytes_bitser = (nrows_a * ncols_a * nbits) / 8;
+    uint64_t * host_bitser = (uint64_t *) staging()->get(nbytes_bitser);
+    p2s_sw(
+      host_buf_src, ncols, nrows, ncols,
+      host_bitser, nrows_a, ncols_a, nbits, issigned
+    );
+    platform->copyBufferHostToAccel((void *)host_bitser, (void *)accel_buf_dst, nbytes_bitser);
+    p2s_record(backend, nrows_a * ncols_a, us_since(t0));
+    return 0;
+  }
+  // p2s shares the DRAM port with the matmul stages, wait for those to
+  // finish and keep the accelerator (and the shared bit-parallel buffer) to
+  // ourselves until done. the wait does not count towards the p2s cost.
+  std::unique_lock<std::mutex> accel_lock = monitor->lock_idle();
+  auto t0 = std::chrono::steady_clock::now();
+  const uint32_t cycles = p2s_hw(
+    host_buf_src, ncols, nrows, ncols,
+    accel_buf_dst, nrows_a, ncols_a, (nrows_a * ncols_a) / 8,
+    nbits, issigned, zeropad
+  );
+  p2s_record(backend, nrows_a * ncols_a, us_since(t0));
+  return cycles;
+}
+
+uint32_t p2s_hw(
+  const uint8_t * src, size_t src_stride, size_t nrows, size_t ncols,
+  uint32_t dst, size_t nrows_a, size_t ncols_a, size_t dst_plane_stride,
+  size_t nbits, bool issigned, bool zeropad
+) {
   // nbytes per aligned row, accel side stride
   size_t nbytes_per_aligned_row = ncols_a * sizeof(uint8_t);
-  // nbytes per original row, host side stride
+  // nbytes per original row
   size_t nbytes_per_row = ncols * sizeof(uint8_t);
-  // nbytes needed in the accel-side bit parallel buffer
-  size_t nbytes_bitpar_aligned = nrows_a * ncols_a * sizeof(uint8_t);
-  // nbytes needed in the accel-side bit serial buffer
-  const size_t nbytes_bitser = (nrows_a * ncols_a * nbits) / 8;
-  if(nbytes_bitpar_aligned > BISMORT_P2S_BITPAR_BYTES) {
-    throw "Insufficient p2s bit-parallel buffer size";
+  // matrices that do not fit into the bit-parallel buffer are streamed
+  // through its two halves in groups of rows: the host copies in the next
+  // group while the p2s accelerator converts the current one
+  size_t rows_per_chunk = nrows_a;
+  if(nrows_a * nbytes_per_aligned_row > BISMORT_P2S_BITPAR_BYTES) {
+    rows_per_chunk = (BISMORT_P2S_BITPAR_BYTES / 2) / nbytes_per_aligned_row;
   }
-  // TODO optimization: allocate this only once
-  uint8_t * host_p2s_bitpar_buffer = new uint8_t[nbytes_bitpar_aligned];
-  // clean the p2s buffer if desired
-  if(zeropad) {
-    // hand in a "cleanly padded" buffer to p2s
-    memset(host_p2s_bitpar_buffer, 0, nbytes_bitpar_aligned);
+  if(rows_per_chunk == 0) {
+    throw "Insufficient p2s bit-parallel buffer size";
   }
-  // aligned copy the bit-parallel matrix into the accelerator
-  for(size_t r = 0; r < nrows; r++) {
-    std::memcpy((void *)(host_p2s_bitpar_buffer + (r * nbytes_per_aligned_row)), (void *)&host_buf_src[r * nbytes_per_row], nbytes_per_row);
+  const size_t nchunks = (nrows_a + rows_per_chunk - 1) / rows_per_chunk;
+  const uint32_t accel_half[2] = {
+    accel_p2s_bitpar_buffer, accel_p2s_bitpar_buffer + BISMORT_P2S_BITPAR_BYTES / 2
+  };
+  // aligned copy of rows [r0, r0 + nr) into the accelerator bit-parallel buffer
+  auto stage = [&](size_t r0, size_t nr, uint32_t accel_bitpar) {
+    const size_t nbytes = nr * nbytes_per_aligned_row;
+    uint8_t * host_p2s_bitpar_buffer = staging()->get(nbytes);
+    const size_t r_end = std::min(r0 + nr, nrows);
+    for(size_t r = r0; r < r_end; r++) {
+      uint8_t * row = host_p2s_bitpar_buffer + (r - r0) * nbytes_per_aligned_row;
+      copy_mem(row, &src[r * src_stride], nbytes_per_row, false);
+      // hand in a "cleanly padded" buffer to p2s if desired
+      if(zeropad) {
+        zero_mem(row + nbytes_per_row, nbytes_per_aligned_row - nbytes_per_row, false);
+      }
+    }
+    if(zeropad && r_end < r0 + nr) {
+      zero_mem(
+        host_p2s_bitpar_buffer + (r_end - r0) * nbytes_per_aligned_row,
+        (r0 + nr - r_end) * nbytes_per_aligned_row, false
+      );
+    }
+    platform->copyBufferHostToAccel((void *)host_p2s_bitpar_buffer, (void *)accel_bitpar, nbytes);
+  };
+  stage(0, std::min(rows_per_chunk, nrows_a), accel_half[0]);
+  uint32_t cycles = 0;
+  for(size_t c = 0; c < nchunks; c++) {
+    const size_t r0 = c * rows_per_chunk;
+    const size_t nr = std::min(rows_per_chunk, nrows_a - r0);
+    // setup and call the p2s hardware accelerator
+    acc->setup_p2s(
+      (void *) accel_half[c % 2],                         // source buffer
+      (nr * ncols_a * nbits) / 8,                         // num bytes to be written to dest
+      (void *) (dst + (r0 * ncols_a) / 8),                // dest buffer
+      nr, ncols_a, nbits,                                 // dimensions
+      issigned,
+      dst_plane_stride                                    // dest bit plane stride
+    );
+    acc->p2s_start();
+    if(c + 1 < nchunks) {
+      const size_t r0_next = r0 + rows_per_chunk;
+      stage(r0_next, std::min(rows_per_chunk, nrows_a - r0_next), accel_half[(c + 1) % 2]);
+    }
+    cycles += acc->p2s_wait();
   }
-  platform->copyBufferHostToAccel((void *)host_p2s_bitpar_buffer, (void *)accel_p2s_bitpar_buffer, nbytes_bitpar_aligned);
-  // setup and call the p2s hardware accelerator
-  acc->setup_p2s(
-    (void *)accel_p2s_bitpar_buffer,  // source buffer
-    nbytes_bitser,                    // num bytes to be written to dest
-    (void *) accel_buf_dst,           // dest buffer
-    nrows_a, ncols_a, nbits,          // dimensions
-    issigned
-  );
-  uint32_t cycles = acc->p2s_exec_and_wait();
-  instrumentationData["run_p2s"] = (float) cycles;
-#endif
+  return cycles;
 }
 
 bool selftest_p2s() {
   bool ret = true;
   vector<size_t> yesno {0, 1};
   vector<size_t> nbits_alts {1, 2, 3};
-  vector<size_t> spatial_alts_r {1, 10, 20};
+  // the largest size is streamed through the p2s buffer in several chunks
+  vector<size_t> spatial_alts_r {1, 10, 20, 4096};
   vector<size_t> spatial_alts_c {100, 256, 512, 1000};
+  vector<P2SBackend> backends {p2sBackendHW, p2sBackendSW};
+  const P2SBackend prev_backend = getP2SBackend();
   for(auto & nbits: nbits_alts) {
     for(auto & nrows: spatial_alts_r) {
       for(auto & ncols: spatial_alts_c) {
@@ -121,21 +267,31 @@ bool selftest_p2s() {
           TIMER_REPORT("run_p2s_benchmark_sw");
           size_t nbytes_bitser = mat_bs.wordsPerBitplane() * nbits * sizeof(PackedBitGroupType);
           uint32_t accel_buf = (uint32_t)(uint64_t)platform->allocAccelBuffer(nbytes_bitser);
-          // call p2s with forced zero-padding and align to cfg.dpaDimRHS
-          p2s(mat_bp, accel_buf, nrows, ncols, nbits, issigned, true, cfg.dpaDimRHS);
-          // copy result back to host
           uint8_t * accel_mat_bs = new uint8_t[nbytes_bitser];
-          platform->copyBufferAccelToHost((void *)accel_buf, accel_mat_bs, nbytes_bitser);
-          ret &= (memcmp(accel_mat_bs, mat_bs.data, nbytes_bitser) == 0);
-          /*if(!ret) {
-            for(size_t i = 0; i < nbytes_bitser; i++) {
-              if(accel_mat_bs[i] != ((uint8_t*)mat_bs.data)[i]) {
-                cout << i << "\t" <<  hex << (int)accel_mat_bs[i] << "\t" << (int)((uint8_t*)mat_bs.data)[i] << dec << endl;
-              }
+          // both backends must produce exactly the same layout
+          for(auto & backend : backends) {
+            setP2SBackend(backend);
+            memset(accel_mat_bs, 0xff, nbytes_bitser);
+            platform->copyBufferHostToAccel(accel_mat_bs, (void *)accel_buf, nbytes_bitser);
+            // call p2s with forced zero-padding and align to cfg.dpaDimRHS
+            TIMER_SAMPLE();
+            const uint32_t cycles = p2s(
+              mat_bp, accel_buf, nrows, ncols, nbits, issigned, true, cfg.dpaDimRHS
+            );
+            TIMER_SAMPLE();
+            TIMER_REPORT("run_p2s_benchmark_rt");
+            // copy result back to host
+            platform->copyBufferAccelToHost((void *)accel_buf, accel_mat_bs, nbytes_bitser);
+            bool ok = (memcmp(accel_mat_bs, mat_bs.data, nbytes_bitser) == 0);
+            ret &= ok;
+            cout << test_name << (backend == p2sBackendHW ? "_hw" : "_sw");
+            cout << "\tok? = " << ok << "\tus = " << instrumentationData["run_p2s_benchmark_rt_us"];
+            if(backend == p2sBackendHW) {
+              cout << "\tcycles = " << cycles;
             }
-          }*/
-          cout << test_name << "\tok? = " << ret << "\tcycles = " << instrumentationData["run_p2s"];
-          cout << " software importRegular us = " << instrumentationData["run_p2s_benchmark_sw"] << endl;
+            cout << endl;
+          }
+          cout << "gemmbitserial importRegular us = " << instrumentationData["run_p2s_benchmark_sw_us"] << endl;
           platform->deallocAccelBuffer((void *)accel_buf);
           delete [] accel_mat_bs;
           delete [] mat_bp;
@@ -143,6 +299,7 @@ bool selftest_p2s() {
       }
     }
   }
+  setP2SBackend(prev_backend);
   cout << "All tests passed? " << ret << endl;
   return ret;
 }
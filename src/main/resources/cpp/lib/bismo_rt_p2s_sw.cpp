@@ -0,0 +1,262 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_internal.hpp"
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace bismo_rt {
+
+// transpose 64 uint8 elements into bit planes: bit i of planes[b] is bit b
+// of element i. if issigned, the sign bit (bit 7) is moved into the top
+// plane the same way the p2s accelerator does it.
+static inline void transpose64(
+  const uint8_t * src, size_t nbits, bool issigned, uint64_t * planes
+) {
+  const size_t nplanes = issigned ? 8 : nbits;
+#if defined(__AVX2__)
+  const __m256i v0 = _mm256_loadu_si256((const __m256i *) src);
+  const __m256i v1 = _mm256_loadu_si256((const __m256i *) (src + 32));
+  for(size_t b = 0; b < nplanes; b++) {
+    // move bit b of each byte to its MSB, then gather the MSBs
+    const uint32_t m0 = _mm256_movemask_epi8(_mm256_slli_epi64(v0, 7 - b));
+    const uint32_t m1 = _mm256_movemask_epi8(_mm256_slli_epi64(v1, 7 - b));
+    planes[b] = (uint64_t) m0 | ((uint64_t) m1 << 32);
+  }
+#elif defined(__SSE2__)
+  __m128i v[4];
+  for(size_t i = 0; i < 4; i++) {
+    v[i] = _mm_loadu_si128((const __m128i *) (src + 16 * i));
+  }
+  for(size_t b = 0; b < nplanes; b++) {
+    const __m128i sh = _mm_cvtsi32_si128(7 - b);
+    uint64_t p = 0;
+    for(size_t i = 0; i < 4; i++) {
+      p |= (uint64_t)(uint16_t) _mm_movemask_epi8(_mm_sll_epi64(v[i], sh)) << (16 * i);
+    }
+    planes[b] = p;
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  static const uint8_t w[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t weights = vld1q_u8(w);
+  uint8x16_t v[4];
+  for(size_t i = 0; i < 4; i++) {
+    v[i] = vld1q_u8(src + 16 * i);
+  }
+  for(size_t b = 0; b < nplanes; b++) {
+    const uint8x16_t bit = vdupq_n_u8(1 << b);
+    uint64_t p = 0;
+    for(size_t i = 0; i < 4; i++) {
+      // 0xff where bit b is set, weighted by the position within 8 bytes
+      // and summed up to get one byte of mask per 8 elements
+      const uint8x16_t t = vandq_u8(vtstq_u8(v[i], bit), weights);
+      const uint64x2_t s = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(t)));
+      p |= (vgetq_lane_u64(s, 0) | (vgetq_lane_u64(s, 1) << 8)) << (16 * i);
+    }
+    planes[b] = p;
+  }
+#else
+  for(size_t b = 0; b < nplanes; b++) {
+    uint64_t p = 0;
+    for(size_t i = 0; i < 8; i++) {
+      uint64_t x;
+      memcpy(&x, src + 8 * i, sizeof(x));
+      // gather bit b of each of the 8 bytes into one byte
+      const uint64_t m = (x >> b) & 0x0101010101010101ULL;
+      p |= ((m * 0x0102040810204080ULL) >> 56) << (8 * i);
+    }
+    planes[b] = p;
+  }
+#endif
+  if(issigned) {
+    planes[nbits - 1] |= planes[7];
+  }
+}
+
+static void p2s_sw_rows(
+  const uint8_t * src, size_t src_stride, size_t nrows, size_t ncols,
+  uint64_t * dst, size_t nrows_a, size_t ncols_a, size_t nbits, bool issigned,
+  size_t row_start, size_t row_end
+) {
+  const size_t words_per_row = ncols_a / 64;
+  const size_t words_per_plane = nrows_a * words_per_row;
+  uint8_t tail[64];
+  uint64_t planes[8];
+  for(size_t r = row_start; r < row_end; r++) {
+    const uint8_t * row = src + r * src_stride;
+    for(size_t w = 0; w < words_per_row; w++) {
+      const size_t c0 = w * 64;
+      const size_t dst_ind = r * words_per_row + w;
+      if(r >= nrows || c0 >= ncols) {
+        // padding is all zeroes
+        for(size_t b = 0; b < nbits; b++) {
+          dst[b * words_per_plane + dst_ind] = 0;
+        }
+        continue;
+      }
+      const uint8_t * p = row + c0;
+      if(c0 + 64 > ncols) {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, p, ncols - c0);
+        p = tail;
+      }
+      transpose64(p, nbits, issigned, planes);
+      for(size_t b = 0; b < nbits; b++) {
+        dst[b * words_per_plane + dst_ind] = planes[b];
+      }
+    }
+  }
+}
+
+// persistent helper threads for the software p2s, created on first use and
+// shared by all callers, so that concurrent conversions from several threads
+// do not start a full set of threads each
+class P2SWorkerPool {
+public:
+  ~P2SWorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_stop = true;
+    }
+    m_work.notify_all();
+    for(auto & w : m_workers) {
+      w.join();
+    }
+  }
+
+  // run all tasks with up to nworkers helper threads and return when they
+  // are done. the calling thread runs the first task, then helps with the
+  // queued ones.
+  void run(std::vector<std::function<void()>> & tasks, size_t nworkers) {
+    Batch batch;
+    batch.remaining = tasks.size() - 1;
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      while(m_workers.size() < nworkers) {
+        m_workers.push_back(std::thread(&P2SWorkerPool::worker, this));
+      }
+      for(size_t i = 1; i < tasks.size(); i++) {
+        m_queue.push_back(std::make_pair(&tasks[i], &batch));
+      }
+    }
+    m_work.notify_all();
+    tasks[0]();
+    std::unique_lock<std::mutex> lock(m_lock);
+    while(batch.remaining > 0) {
+      if(!m_queue.empty()) {
+        run_one(lock);
+      } else {
+        m_done.wait(lock);
+      }
+    }
+  }
+
+private:
+  struct Batch {
+    size_t remaining;
+  };
+
+  // run the first queued task with the lock released
+  void run_one(std::unique_lock<std::mutex> & lock) {
+    auto job = m_queue.front();
+    m_queue.pop_front();
+    lock.unlock();
+    (*job.first)();
+    lock.lock();
+    if(--job.second->remaining == 0) {
+      m_done.notify_all();
+    }
+  }
+
+  void worker() {
+    std::unique_lock<std::mutex> lock(m_lock);
+    while(true) {
+      m_work.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      if(m_stop) {
+        return;
+      }
+      run_one(lock);
+    }
+  }
+
+  std::mutex m_lock;
+  std::condition_variable m_work, m_done;
+  std::deque<std::pair<std::function<void()> *, Batch *>> m_queue;
+  std::vector<std::thread> m_workers;
+  bool m_stop = false;
+};
+
+void p2s_sw(
+  const uint8_t * src, size_t src_stride, size_t nrows, size_t ncols,
+  uint64_t * dst, size_t nrows_a, size_t ncols_a, size_t nbits, bool issigned
+) {
+  if(ncols_a % 64 != 0) {
+    throw "Software p2s requires the number of columns to be aligned to 64";
+  }
+  // split rows between threads, small matrices are not worth it
+  size_t nthreads = BISMORT_SW_P2S_THREADS;
+  if(nthreads == 0) {
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if(nrows_a * ncols_a < BISMORT_SW_P2S_MT_MIN_BYTES) {
+    nthreads = 1;
+  }
+  nthreads = std::min(nthreads, nrows_a);
+  const size_t rows_per_thread = (nrows_a + nthreads - 1) / nthreads;
+  if(nthreads == 1) {
+    p2s_sw_rows(
+      src, src_stride, nrows, ncols, dst, nrows_a, ncols_a, nbits, issigned,
+      0, nrows_a
+    );
+    return;
+  }
+  std::vector<std::function<void()>> tasks;
+  for(size_t row_start = 0; row_start < nrows_a; row_start += rows_per_thread) {
+    const size_t row_end = std::min(nrows_a, row_start + rows_per_thread);
+    tasks.push_back([=] {
+      p2s_sw_rows(
+        src, src_stride, nrows, ncols, dst, nrows_a, ncols_a, nbits, issigned,
+        row_start, row_end
+      );
+    });
+  }
+  static P2SWorkerPool workers;
+  workers.run(tasks, nthreads - 1);
+}
+
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_plan_cache.hpp"
+#include "bismo_rt_matmul.hpp"
+
+namespace bismo_rt {
+
+PlanCache::PlanCache(size_t capacity_bytes) {
+  m_capacity = capacity_bytes;
+  m_bytes_cached = 0;
+  m_num_hits = 0;
+  m_num_misses = 0;
+}
+
+PlanCache::~PlanCache() {
+  clear();
+}
+
+PlanCache::PlanKey PlanCache::key(const MatMulDescriptor & dsc) {
+  return PlanKey(
+    dsc.M, dsc.K, dsc.N, dsc.wbits, dsc.ibits, dsc.wsigned, dsc.isigned
+  );
+}
+
+PlanCache::PlanKey PlanCache::key(MatrixMultiply * mm) {
+  return PlanKey(
+    mm->M(), mm->K(), mm->N(), mm->m_lhs->bits(), mm->m_rhs->bits(),
+    mm->m_lhs->is_signed(), mm->m_rhs->is_signed()
+  );
+}
+
+void PlanCache::destroy(MatrixMultiply * mm) {
+  delete mm->m_lhs;
+  delete mm->m_rhs;
+  delete mm->m_res;
+  delete mm;
+}
+
+MatrixMultiply * PlanCache::acquire(const MatMulDescriptor & dsc) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  auto it = m_index.find(key(dsc));
+  if(it == m_index.end()) {
+    m_num_misses++;
+    return 0;
+  }
+  MatrixMultiply * mm = it->second->second;
+  m_lru.erase(it->second);
+  m_index.erase(it);
+  m_bytes_cached -= mm->accelBytes();
+  m_num_hits++;
+  return mm;
+}
+
+void PlanCache::release(MatrixMultiply * mm) {
+  PlanList evicted;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    if(mm->accelBytes() > m_capacity) {
+      evicted.push_back(std::make_pair(key(mm), mm));
+    } else {
+      // the next user of this matrix multiply should not see any of the
+      // state of the previous one
+      mm->recycle();
+      m_lru.push_front(std::make_pair(key(mm), mm));
+      m_index.insert(std::make_pair(key(mm), m_lru.begin()));
+      m_bytes_cached += mm->accelBytes();
+      evicted = evict(m_capacity);
+    }
+  }
+  // freeing takes the buffer pool lock, do it outside our own
+  for(auto & e : evicted) {
+    destroy(e.second);
+  }
+}
+
+PlanCache::PlanList PlanCache::evict(size_t max_bytes) {
+  PlanList evicted;
+  while(m_bytes_cached > max_bytes) {
+    auto & e = m_lru.back();
+    auto range = m_index.equal_range(e.first);
+    for(auto it = range.first; it != range.second; it++) {
+      if(it->second->second == e.second) {
+        m_index.erase(it);
+        break;
+      }
+    }
+    m_bytes_cached -= e.second->accelBytes();
+    evicted.splice(evicted.end(), m_lru, std::prev(m_lru.end()));
+  }
+  return evicted;
+}
+
+void PlanCache::set_capacity(size_t capacity_bytes) {
+  PlanList evicted;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_capacity = capacity_bytes;
+    evicted = evict(m_capacity);
+  }
+  for(auto & e : evicted) {
+    destroy(e.second);
+  }
+}
+
+void PlanCache::clear() {
+  PlanList evicted;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    evicted = evict(0);
+  }
+  for(auto & e : evicted) {
+    destroy(e.second);
+  }
+}
+
+size_t PlanCache::bytes_cached() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_bytes_cached;
+}
+
+size_t PlanCache::num_hits() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_num_hits;
+}
+
+size_t PlanCache::num_misses() const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  return m_num_misses;
+}
+
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_PLAN_CACHE_HPP
+#define BISMORT_PLAN_CACHE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include "bismo_rt.hpp"
+
+namespace bismo_rt {
+
+class MatrixMultiply;
+
+// cache of matrix multiplies whose layers were deinitialized, so that a later
+// initMatMul with the same shape, precision and signedness can reuse one
+// instead of allocating matrices and building descriptors again. the least
+// recently released ones are freed to keep their accelerator memory below
+// the capacity. safe to use from several threads.
+class PlanCache {
+public:
+  PlanCache(size_t capacity_bytes);
+  // frees all cached matrix multiplies
+  ~PlanCache();
+  // take out a cached matrix multiply for dsc, or return 0 if there is none
+  MatrixMultiply * acquire(const MatMulDescriptor & dsc);
+  // hand a matrix multiply and its matrices to the cache, which may free them
+  // right away. the accelerator must be done with it.
+  void release(MatrixMultiply * mm);
+  // set the max accelerator bytes held by cached matrix multiplies, 0 to
+  // disable caching
+  void set_capacity(size_t capacity_bytes);
+  // free all cached matrix multiplies
+  void clear();
+  // accelerator bytes held by cached matrix multiplies
+  size_t bytes_cached() const;
+  // number of acquire calls that found / did not find a cached one
+  size_t num_hits() const;
+  size_t num_misses() const;
+  // frees a matrix multiply together with its matrices
+  static void destroy(MatrixMultiply * mm);
+
+protected:
+  // M, K, N, wbits, ibits, wsigned, isigned
+  typedef std::tuple<size_t, size_t, size_t, size_t, size_t, bool, bool> PlanKey;
+  typedef std::list<std::pair<PlanKey, MatrixMultiply *>> PlanList;
+  static PlanKey key(const MatMulDescriptor & dsc);
+  static PlanKey key(MatrixMultiply * mm);
+  // remove the least recently released entries until at most max_bytes are
+  // cached and return them, with m_lock held
+  PlanList evict(size_t max_bytes);
+  // guards all members below
+  mutable std::mutex m_lock;
+  size_t m_capacity;
+  // most recently released first
+  PlanList m_lru;
+  std::multimap<PlanKey, PlanList::iterator> m_index;
+  size_t m_bytes_cached;
+  size_t m_num_hits;
+  size_t m_num_misses;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_PLAN_CACHE_HPP */
@@ -34,6 +34,7 @@
 
 #include <string>
 #include "wrapperregdriver.h"
+#include "bismo_rt_internal.hpp"
 
 namespace bismo_rt {
 
@@ -54,7 +55,7 @@ public:
     m_name = name;
     m_is_host_dirty = true;
     m_is_const = is_const;
-    m_accelbuf = (uint32_t)(uint64_t) m_platform->allocAccelBuffer(nbytes());
+    m_accelbuf = pool->alloc(nbytes());
     if(m_is_coherent) {
       m_hostbuf = (T *) platform->phys2virt((void *) m_accelbuf);
     } else {
@@ -63,7 +64,7 @@ public:
   };
 
   ~SharedBuffer() {
-    m_platform->deallocAccelBuffer((void *) m_accelbuf);
+    pool->dealloc(m_accelbuf);
     if(!m_is_coherent) {
       delete [] m_hostbuf;
     }
@@ -79,6 +80,17 @@ public:
     }
   };
 
+  // copy n_elems elements starting at element first from the accel buffer to
+  // the host buffer
+  void accel2host(size_t first, size_t n_elems) {
+    if(!m_is_coherent) {
+      m_platform->copyBufferAccelToHost(
+        (void *) (m_accelbuf + first * sizeof(T)), (void *) (m_hostbuf + first),
+        n_elems * sizeof(T)
+      );
+    }
+  };
+
   // copy host buffer to accel buffer
   void host2accel() {
     if(!m_is_coherent) {
@@ -94,6 +106,17 @@ public:
     }
   };
 
+  // copy n_elems elements starting at element first from the host buffer to
+  // the accel buffer, regardless of the const flag
+  void host2accel(size_t first, size_t n_elems) {
+    if(!m_is_coherent) {
+      m_platform->copyBufferHostToAccel(
+        (void *) (m_hostbuf + first), (void *) (m_accelbuf + first * sizeof(T)),
+        n_elems * sizeof(T)
+      );
+    }
+  };
+
   // return the number of bytes occupied in the host buffer
   const size_t nbytes() const {
     return m_n_elems * sizeof(T);
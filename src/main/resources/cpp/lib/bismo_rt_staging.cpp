@@ -0,0 +1,91 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_staging.hpp"
+#include "bismo_rt_options.hpp"
+#include <stdlib.h>
+#include <algorithm>
+
+namespace bismo_rt {
+
+std::atomic<size_t> StagingArena::s_overall_high_water(0);
+
+StagingArena::StagingArena(size_t initial_bytes) {
+  m_buf = 0;
+  m_capacity = 0;
+  m_high_water = 0;
+  if(initial_bytes > 0) {
+    resize(initial_bytes);
+  }
+}
+
+StagingArena::~StagingArena() {
+  free(m_buf);
+}
+
+void StagingArena::resize(size_t nbytes) {
+  free(m_buf);
+  m_buf = 0;
+  m_capacity = 0;
+  void * buf;
+  if(posix_memalign(&buf, BISMORT_CACHELINE_BYTES, nbytes) != 0) {
+    throw "Failed to allocate host staging buffer";
+  }
+  m_buf = (uint8_t *) buf;
+  m_capacity = nbytes;
+}
+
+uint8_t * StagingArena::get(size_t nbytes) {
+  if(nbytes > m_high_water) {
+    m_high_water = nbytes;
+    size_t prev = s_overall_high_water.load();
+    while(prev < nbytes && !s_overall_high_water.compare_exchange_weak(prev, nbytes));
+  }
+  if(nbytes > m_capacity) {
+    // grow at least geometrically to avoid repeated reallocation
+    resize(std::max(nbytes, 2 * m_capacity));
+  }
+  return m_buf;
+}
+
+size_t StagingArena::capacity() const {
+  return m_capacity;
+}
+
+size_t StagingArena::high_water() const {
+  return m_high_water;
+}
+
+size_t StagingArena::overall_high_water() {
+  return s_overall_high_water.load();
+}
+
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_STAGING_HPP
+#define BISMORT_STAGING_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace bismo_rt {
+
+// reusable host-side scratch memory, e.g. for staging data before p2s.
+// the buffer is cache-line aligned and only grows when a larger request
+// arrives, so steady-state use does not allocate. only one user at a time:
+// the pointer returned by get() is valid until the next get() call. the
+// runtime keeps one arena per thread, see staging().
+class StagingArena {
+public:
+  StagingArena(size_t initial_bytes);
+  ~StagingArena();
+  // return a buffer of at least nbytes, growing the arena if needed
+  uint8_t * get(size_t nbytes);
+  // currently allocated bytes
+  size_t capacity() const;
+  // largest request seen so far
+  size_t high_water() const;
+  // largest request seen so far by any arena
+  static size_t overall_high_water();
+
+protected:
+  void resize(size_t nbytes);
+
+  uint8_t * m_buf;
+  size_t m_capacity;
+  size_t m_high_water;
+  static std::atomic<size_t> s_overall_high_water;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_STAGING_HPP */
@@ -31,6 +31,7 @@
 
 #include "bismo_rt_internal.hpp"
 #include "bismo_rt_matrix.hpp"
+#include "bismo_rt_matmul.hpp"
 #include "bismo_rt_shared_buffer.hpp"
 #include "gemmbitserial/test/testhelpers.hpp"
 
@@ -68,6 +69,8 @@ bool selftest_matrix() {
   vector<MatrixType> mtype {matTypeLHS, matTypeRHS, matTypeRes};
   Matrix<uint8_t> * imat;
   Matrix<int32_t> * rmat;
+  vector<P2SBackend> backends {p2sBackendHW, p2sBackendSW};
+  const P2SBackend prev_backend = getP2SBackend();
   for(auto & nrows: dim) {
     for(auto & ncols: dim) {
       for(auto & mt: mtype) {
@@ -98,37 +101,482 @@ bool selftest_matrix() {
           }
           delete rmat;
         } else {
-          imat = new Matrix<uint8_t>(
-            nrows, ncols, 1, false, mt != matTypeLHS, mt
-          );
-          imat->printSummary();
-          uint8_t * buf = imat->hostbuf();
-          int32_t elem_sum = 0;
-          size_t n_zeros = 0;
-          for(int i = 0; i < imat->elems(); i++) {
-            buf[i] = i+1;
+          // bit-serial matrices are padded on the way to the bit-serial
+          // buffer, check that against gemmbitserial with both backends
+          const size_t nbits = 2;
+          for(auto & backend : backends) {
+            setP2SBackend(backend);
+            imat = new Matrix<uint8_t>(
+              nrows, ncols, nbits, false, mt != matTypeLHS, mt
+            );
+            imat->printSummary();
+            gemmbitserial::generateRandomVector(nbits, imat->elems(), imat->hostbuf());
+            imat->host2accel();
+            gemmbitserial::BitSerialMatrix ref = gemmbitserial::BitSerialMatrix::alloc(
+              nbits, imat->outer(), imat->inner(), false,
+              mt == matTypeLHS ? cfg.dpaDimLHS : cfg.dpaDimRHS, cfg.dpaDimCommon
+            );
+            ref.importRegular(imat->hostbuf());
+            const size_t nbytes = imat->bitserial_nbytes();
+            uint8_t * bs = new uint8_t[nbytes];
+            platform->copyBufferAccelToHost((void *) imat->bitserial_accelbuf(), bs, nbytes);
+            all_ok &= (memcmp(bs, ref.data, nbytes) == 0);
+            delete [] bs;
+            gemmbitserial::BitSerialMatrix::dealloc(ref);
+            delete imat;
           }
-          imat->host2accel();
-          // check contents of padded host buf
-          //gemmbitserial::printmatrix(mat->hostbuf(), mat->outer(), mat->inner());
-          //gemmbitserial::printmatrix(mat->padded_hostbuf(), mat->outer_a(), mat->inner_a());
-          for(size_t i = 0; i < imat->elems_a(); i++) {
-            n_zeros += (imat->padded_hostbuf()[i] == 0 ? 1 : 0);
-            elem_sum += imat->padded_hostbuf()[i];
-          }
-          all_ok &= ( elem_sum == (imat->elems() * (imat->elems() + 1))/2 );
-          all_ok &= ( n_zeros == imat->elems_a() - imat->elems() );
-          imat->accel2host();
-          for(int i = 0; i < imat->elems(); i++) {
-            all_ok &= (buf[i] == i+1);
-          }
-          delete imat;
         }
       }
     }
   }
+  setP2SBackend(prev_backend);
   cout << "Test result " << test_name << ":" << all_ok << endl;
   return all_ok;
 }
 
+
+bool selftest_partial_sync() {
+  bool all_ok = true;
+  string test_name = "selftest_partial_sync";
+  cout << "Starting test:" << test_name << endl;
+  const size_t K = 300, N = 20, nbits = 3;
+  vector<P2SBackend> backends {p2sBackendHW, p2sBackendSW};
+  // inner and outer chunk sizes, 0 for none
+  vector<pair<size_t, size_t>> chunks {
+    {0, 0}, {2 * cfg.dpaDimCommon, 0}, {2 * cfg.dpaDimCommon, 2 * cfg.dpaDimRHS}
+  };
+  const P2SBackend prev_backend = getP2SBackend();
+  for(auto & backend : backends) {
+    setP2SBackend(backend);
+    for(auto & chunk : chunks) {
+      Matrix<uint8_t> * m = new Matrix<uint8_t>(K, N, nbits, false, true, matTypeRHS);
+      Matrix<uint8_t> * ref = new Matrix<uint8_t>(K, N, nbits, false, true, matTypeRHS);
+      if(chunk.first) {
+        m->set_inner_chunk(chunk.first);
+        ref->set_inner_chunk(chunk.first);
+      }
+      if(chunk.second) {
+        m->set_outer_chunk(chunk.second);
+      }
+      gemmbitserial::generateRandomVector(nbits, K * N, m->hostbuf());
+      m->host2accel();
+      // change columns 5..8 and 15, but only mark the first ones as dirty
+      uint8_t * buf = m->hostbuf();
+      for(size_t i = 5 * K; i < 9 * K; i++) {
+        buf[i] = (buf[i] + 1) % (1 << nbits);
+      }
+      memcpy(ref->hostbuf(), buf, K * N);
+      for(size_t i = 15 * K; i < 16 * K; i++) {
+        buf[i] = (buf[i] + 1) % (1 << nbits);
+      }
+      m->mark_dirty(5, 7);
+      m->mark_dirty(7, 9);
+      all_ok &= m->needs_sync();
+      m->host2accel();
+      ref->host2accel();
+      // the bit-serial data must match the full conversion of the data
+      // where column 15 did not change. the reference has no outer chunks,
+      // each bit plane of an outer chunk is a slice of its bit plane.
+      const size_t nbytes = m->bitserial_nbytes();
+      uint8_t * bs_m = new uint8_t[nbytes];
+      uint8_t * bs_ref = new uint8_t[nbytes];
+      platform->copyBufferAccelToHost((void *) m->bitserial_accelbuf(), bs_m, nbytes);
+      platform->copyBufferAccelToHost((void *) ref->bitserial_accelbuf(), bs_ref, nbytes);
+      for(size_t o = 0; o < m->num_outer_chunks(); o++) {
+        for(size_t c = 0; c < m->num_inner_chunks(); c++) {
+          const size_t chunk_a = m->inner_chunk_a(c);
+          const size_t plane_nbytes = (m->outer_chunk_a(o) * chunk_a) / 8;
+          for(size_t b = 0; b < nbits; b++) {
+            const uint8_t * got = bs_m + (m->bitserial_accelbuf(o, c) - m->bitserial_accelbuf()) + b * plane_nbytes;
+            const uint8_t * exp = bs_ref + (ref->bitserial_accelbuf(0, c) - ref->bitserial_accelbuf()) +
+              ((b * ref->outer_a() + o * m->outer_chunk()) * chunk_a) / 8;
+            all_ok &= (memcmp(got, exp, plane_nbytes) == 0);
+          }
+        }
+      }
+      delete [] bs_m;
+      delete [] bs_ref;
+      delete m;
+      delete ref;
+    }
+  }
+  setP2SBackend(prev_backend);
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_bind() {
+  bool all_ok = true;
+  string test_name = "selftest_bind";
+  cout << "Starting test:" << test_name << endl;
+  const size_t M = 13, K = 100, stride = 160, nbits = 3;
+  vector<P2SBackend> backends {p2sBackendHW, p2sBackendSW};
+  const P2SBackend prev_backend = getP2SBackend();
+  // caller memory with rows further apart than K, and something else between
+  uint8_t * user = new uint8_t[M * stride];
+  gemmbitserial::generateRandomVector(nbits, M * stride, user);
+  for(auto & backend : backends) {
+    setP2SBackend(backend);
+    Matrix<uint8_t> * m = new Matrix<uint8_t>(M, K, nbits, false, false, matTypeLHS);
+    Matrix<uint8_t> * ref = new Matrix<uint8_t>(M, K, nbits, false, false, matTypeLHS);
+    Matrix<uint8_t>::copy2d_strided(user, ref->hostbuf(), M, K, stride, K);
+    m->bind(user, stride);
+    m->host2accel();
+    ref->host2accel();
+    const size_t nbytes = m->bitserial_nbytes();
+    uint8_t * bs_m = new uint8_t[nbytes];
+    uint8_t * bs_ref = new uint8_t[nbytes];
+    platform->copyBufferAccelToHost((void *) m->bitserial_accelbuf(), bs_m, nbytes);
+    platform->copyBufferAccelToHost((void *) ref->bitserial_accelbuf(), bs_ref, nbytes);
+    all_ok &= (memcmp(bs_m, bs_ref, nbytes) == 0);
+    // the host buffer itself is not used while bound
+    all_ok &= (memcmp(m->gather_hostbuf(), ref->hostbuf(), M * K) == 0);
+    delete [] bs_m;
+    delete [] bs_ref;
+    delete m;
+    delete ref;
+  }
+  delete [] user;
+  setP2SBackend(prev_backend);
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_partial_readback() {
+  bool all_ok = true;
+  string test_name = "selftest_partial_readback";
+  cout << "Starting test:" << test_name << endl;
+  const size_t M = 37, N = 11;
+  // a few rows of a few columns (strided), and a few full columns
+  const size_t regions[2][4] = {{3, 5, 2, 4}, {0, M, 7, 3}};
+  // also with the rows split into chunks, as for M-tiled matrix multiplies
+  vector<size_t> chunks {0, 2 * cfg.dpaDimLHS};
+  for(auto & chunk : chunks) {
+    for(auto & reg : regions) {
+      const size_t row0 = reg[0], nrows = reg[1], col0 = reg[2], ncols = reg[3];
+      Matrix<int32_t> * m = new Matrix<int32_t>(M, N, 32, true, true, matTypeRes);
+      if(chunk) {
+        m->set_inner_chunk(chunk);
+      }
+      int32_t * buf = m->hostbuf();
+      for(size_t i = 0; i < m->elems(); i++) {
+        buf[i] = i + 1;
+      }
+      m->host2accel();
+      memset(buf, 0, m->elems() * sizeof(int32_t));
+      m->accel2host(col0, col0 + ncols, row0, row0 + nrows);
+      // col-major: the requested region is back, everything else untouched
+      for(size_t c = 0; c < N; c++) {
+        for(size_t r = 0; r < M; r++) {
+          const bool inside = (c >= col0 && c < col0 + ncols && r >= row0 && r < row0 + nrows);
+          all_ok &= (buf[c * M + r] == (inside ? (int32_t)(c * M + r + 1) : 0));
+        }
+      }
+      delete m;
+    }
+  }
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_accel_pool() {
+  bool all_ok = true;
+  string test_name = "selftest_accel_pool";
+  cout << "Starting test:" << test_name << endl;
+  AccelBufferPool * p = new AccelBufferPool(platform);
+  // rounding to size classes
+  all_ok &= (AccelBufferPool::size_class(1) == BISMORT_ACCEL_POOL_MIN_BYTES);
+  all_ok &= (AccelBufferPool::size_class(1024*1024) == 1024*1024);
+  all_ok &= (AccelBufferPool::size_class(1024*1024+1) == 1024*1024 + 256*1024);
+  // a freed buffer is handed out again for a request of the same class
+  uint32_t a = p->alloc(100000);
+  uint32_t b = p->alloc(5000);
+  all_ok &= (p->bytes_in_use() == 105000);
+  p->dealloc(a);
+  all_ok &= (p->bytes_in_use() == 5000);
+  uint32_t c = p->alloc(99000);
+  all_ok &= (c == a);
+  all_ok &= (p->num_platform_allocs() == 2);
+  all_ok &= (p->num_reused() == 1);
+  p->dealloc(b);
+  p->dealloc(c);
+  all_ok &= (p->bytes_in_use() == 0);
+  all_ok &= (p->fragmentation() == 1.0f);
+  p->release();
+  all_ok &= (p->bytes_reserved() == 0);
+  // beyond the free byte cap, the buffer freed first is given back first
+  const size_t sc = AccelBufferPool::size_class(100000);
+  p->set_max_free_bytes(2 * sc);
+  uint32_t d = p->alloc(100000);
+  uint32_t e = p->alloc(100000);
+  uint32_t f = p->alloc(100000);
+  p->dealloc(d);
+  p->dealloc(e);
+  p->dealloc(f);
+  all_ok &= (p->bytes_free() == 2 * sc);
+  all_ok &= (p->bytes_reserved() == 2 * sc);
+  const size_t reused = p->num_reused();
+  uint32_t g = p->alloc(100000);
+  uint32_t h = p->alloc(100000);
+  all_ok &= (g == f && h == e);
+  all_ok &= (p->num_reused() == reused + 2);
+  p->dealloc(g);
+  p->dealloc(h);
+  p->set_max_free_bytes(0);
+  all_ok &= (p->bytes_free() == 0 && p->bytes_reserved() == 0);
+  delete p;
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_plan_cache() {
+  bool all_ok = true;
+  string test_name = "selftest_plan_cache";
+  cout << "Starting test:" << test_name << endl;
+  MatMulDescriptor dsc;
+  dsc.wbits = 2; dsc.ibits = 3; dsc.wsigned = false; dsc.isigned = true;
+  dsc.M = 10; dsc.K = 300; dsc.N = 7;
+  const size_t hits = plans->num_hits();
+  // a layer of the same shape reuses the deinitialized one
+  LayerHandle a = initMatMul(dsc);
+  setLayerLHSConstant(a);
+  const size_t nbytes = ((MatrixMultiply *) a)->accelBytes();
+  deinitMatMul(a);
+  all_ok &= (plans->bytes_cached() == nbytes);
+  LayerHandle b = initMatMul(dsc);
+  all_ok &= (b == a);
+  all_ok &= (plans->num_hits() == hits + 1);
+  all_ok &= (plans->bytes_cached() == 0);
+  all_ok &= (((MatrixMultiply *) b)->m_lhs->is_constant() == false);
+  // other shapes do not
+  dsc.ibits = 4;
+  LayerHandle c = initMatMul(dsc);
+  all_ok &= (c != b);
+  all_ok &= (plans->num_hits() == hits + 1);
+  // the least recently deinitialized layer is freed first
+  deinitMatMul(b);
+  deinitMatMul(c);
+  plans->set_capacity(((MatrixMultiply *) c)->accelBytes());
+  all_ok &= (plans->bytes_cached() == ((MatrixMultiply *) c)->accelBytes());
+  all_ok &= (initMatMul(dsc) == c);
+  deinitMatMul(c);
+  plans->set_capacity(0);
+  all_ok &= (plans->bytes_cached() == 0);
+  plans->set_capacity(BISMORT_PLAN_CACHE_BYTES);
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_histogram() {
+  bool all_ok = true;
+  string test_name = "selftest_histogram";
+  cout << "Starting test:" << test_name << endl;
+  LatencyHistogram h;
+  all_ok &= (h.count() == 0 && h.quantile(0.5) == 0);
+  // small values are exact
+  for(uint64_t v = 1; v <= 10; v++) {
+    h.record(v);
+  }
+  all_ok &= (h.quantile(0.5) == 5);
+  all_ok &= (h.quantile(1.0) == 10);
+  // large values are within 1/16 of the exact quantile
+  h.reset();
+  all_ok &= (h.count() == 0);
+  for(uint64_t v = 1; v <= 100000; v++) {
+    h.record(1000 * v);
+  }
+  const float exact[3] = {50000000.0f, 90000000.0f, 99000000.0f};
+  const float q[3] = {0.5f, 0.9f, 0.99f};
+  for(size_t i = 0; i < 3; i++) {
+    const float err = (float) h.quantile(q[i]) - exact[i];
+    all_ok &= (err <= exact[i] / 16 && -err <= exact[i] / 16);
+  }
+  all_ok &= (h.max() == 100000000);
+  all_ok &= (h.count() == 100000);
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_extended_counter() {
+  bool all_ok = true;
+  string test_name = "selftest_extended_counter";
+  cout << "Starting test:" << test_name << endl;
+  ExtendedCounter c;
+  all_ok &= (c.update(100) == 100);
+  all_ok &= (c.update(0xF0000000) == 0xF0000000);
+  // the hardware counter wraps, the extended one keeps going
+  all_ok &= (c.update(0x10) == 0x100000010);
+  all_ok &= (c.update(0x10) == 0x100000010);
+  for(int i = 0; i < 3; i++) {
+    c.update(0x80000000);
+    c.update(0x10);
+  }
+  all_ok &= (c.update(0x20) == 0x400000020);
+  c.reset();
+  all_ok &= (c.update(5) == 5);
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+bool selftest_memops() {
+  bool all_ok = true;
+  string test_name = "selftest_memops";
+  cout << "Starting test:" << test_name << endl;
+  const size_t bufsize = 512;
+  uint8_t src[bufsize], dst[bufsize], golden[bufsize];
+  for(size_t i = 0; i < bufsize; i++) {
+    src[i] = (uint8_t) (i * 7 + 3);
+  }
+  // cover every relative alignment, including the guard bytes around dst
+  for(size_t src_ofs = 0; src_ofs < 17; src_ofs++) {
+    for(size_t dst_ofs = 0; dst_ofs < 17; dst_ofs++) {
+      for(size_t n = 0; n < 200; n += 13) {
+        for(int device = 0; device < 2; device++) {
+          memset(dst, 0xAA, bufsize);
+          memset(golden, 0xAA, bufsize);
+          copy_mem(dst + dst_ofs, src + src_ofs, n, device);
+          memcpy(golden + dst_ofs, src + src_ofs, n);
+          all_ok &= (memcmp(dst, golden, bufsize) == 0);
+          zero_mem(dst + dst_ofs, n, device);
+          memset(golden + dst_ofs, 0, n);
+          all_ok &= (memcmp(dst, golden, bufsize) == 0);
+        }
+      }
+    }
+  }
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
+
+// schedule that fetches two LHS tiles before releasing one, which the
+// instruction generator must reject
+class DoubleLHSTiling : public TilingPolicy {
+public:
+  const char * name() const {
+    return "double_lhs";
+  }
+  void schedule(const SingleMMDescriptor & dsc, std::vector<TileStep> & steps) const {
+    TileStep step = {0, 0, true, true, false, false};
+    steps.push_back(step);
+    step.fetch_rhs = false;
+    step.release_lhs = step.release_rhs = true;
+    steps.push_back(step);
+  }
+};
+
+bool selftest_instrgen() {
+  bool all_ok = true;
+  string test_name = "selftest_instrgen";
+  cout << "Starting test:" << test_name << endl;
+  InstrGen gen(cfg);
+  InstrStreams all;
+  for(uint8_t bits = 1; bits <= 3; bits++) {
+    SingleMMDescriptor dsc;
+    dsc.tiles_m = 3;
+    dsc.tiles_k = 2;
+    dsc.tiles_n = 2 + bits;
+    dsc.bits_l = bits;
+    dsc.bits_r = 4 - bits;
+    dsc.signed_l = true;
+    dsc.signed_r = false;
+    dsc.base_l = 0;
+    dsc.base_r = 0;
+    dsc.base_res = 0;
+    dsc.accumulate = false;
+    dsc.defer_writeback = false;
+    dsc.nbufs_fetch_exec_log2 = FETCHEXEC_TOKENS_LOG2;
+    // a different tiling for each descriptor
+    dsc.tiling = bits - 1;
+    dsc.dram_lhs = 0x1000;
+    dsc.dram_rhs = 0x2000;
+    dsc.dram_res = 0x3000;
+    InstrStreams s;
+    gen.generate(dsc, s);
+    const size_t steps = dsc.tiles_m * dsc.tiles_n;
+    // number of times the LHS and RHS buffers are filled, and LHS tiles
+    // fetched: once per step for the streamed operand, once per row or
+    // column of tiles for the stationary one, once for a resident LHS
+    size_t nfill_l = steps, nfill_r = dsc.tiles_n, nfetch_l = steps;
+    if(dsc.tiling == tilingLHSRHS) {
+      nfill_l = nfetch_l = dsc.tiles_m;
+      nfill_r = steps;
+    } else if(dsc.tiling == tilingLHSResident) {
+      nfill_l = 1;
+      nfetch_l = dsc.tiles_m;
+    }
+    // fetch: a receive and a send around the fetches for each fill
+    all_ok &= (s.fetch.size() == 2 * (nfill_l + nfill_r) + nfetch_l + nfill_r);
+    // exec: one instruction per pair of bit positions, taking and handing
+    // over a result buffer for each step, and taking and releasing the fills
+    all_ok &= (s.exec.size() == steps * (dsc.bits_l * dsc.bits_r + 2) + 2 * (nfill_l + nfill_r));
+    // result: one write per tile and the final nop
+    all_ok &= (s.result.size() == 3 * steps + 1);
+    all.fetch.insert(all.fetch.end(), s.fetch.begin(), s.fetch.end());
+    all.exec.insert(all.exec.end(), s.exec.begin(), s.exec.end());
+    all.result.insert(all.result.end(), s.result.begin(), s.result.end());
+  }
+  // back-to-back descriptors must be feedable as a single stream
+  std::vector<BISMOInstruction> ins;
+  InstrGen::interleave(all, ins, cfg.resEntriesPerMem);
+  all_ok &= (ins.size() == all.size());
+  // also with a single result buffer in use, see setExecResultBuffers
+  ins.clear();
+  InstrGen::interleave(all, ins, 1);
+  all_ok &= (ins.size() == all.size());
+  // K chunks accumulated on chip: only the last descriptor of the chain
+  // takes a result buffer, and the others neither clear nor write
+  InstrStreams chain;
+  for(int c = 0; c < 3; c++) {
+    SingleMMDescriptor dsc;
+    memset(&dsc, 0, sizeof(dsc));
+    dsc.tiles_m = dsc.tiles_k = dsc.tiles_n = 1;
+    dsc.bits_l = dsc.bits_r = 1;
+    dsc.accumulate = (c > 0);
+    dsc.defer_writeback = (c < 2);
+    dsc.nbufs_fetch_exec_log2 = FETCHEXEC_TOKENS_LOG2;
+    InstrStreams s;
+    gen.generate(dsc, s);
+    for(auto & i : s.exec) {
+      BISMOExecRunInstruction exec;
+      exec.fromRaw(i);
+      if(exec.isRunCfg) {
+        all_ok &= (exec.clear_before_first_accumulation == (c == 0));
+        all_ok &= (exec.shiftAmount == (c == 0));
+        all_ok &= (exec.writeEn == (c == 2));
+      }
+    }
+    all_ok &= (s.exec.size() == (c == 2 ? 7 : 5));
+    all_ok &= (s.result.size() == (c == 2 ? 4 : 1));
+    chain.fetch.insert(chain.fetch.end(), s.fetch.begin(), s.fetch.end());
+    chain.exec.insert(chain.exec.end(), s.exec.begin(), s.exec.end());
+    chain.result.insert(chain.result.end(), s.result.begin(), s.result.end());
+  }
+  ins.clear();
+  InstrGen::interleave(chain, ins, cfg.resEntriesPerMem);
+  all_ok &= (ins.size() == chain.size());
+  // the same descriptor from the same state gives the same instructions
+  SingleMMDescriptor dsc;
+  memset(&dsc, 0, sizeof(dsc));
+  dsc.tiles_m = dsc.tiles_k = dsc.tiles_n = 1;
+  dsc.bits_l = dsc.bits_r = 2;
+  dsc.nbufs_fetch_exec_log2 = FETCHEXEC_TOKENS_LOG2;
+  InstrStreams a, b;
+  gen.reset();
+  gen.generate(dsc, a);
+  gen.reset();
+  gen.generate(dsc, b);
+  all_ok &= (a.fetch == b.fetch && a.exec == b.exec && a.result == b.result);
+  // schedules the exec stage can not follow are rejected
+  DoubleLHSTiling bad_tiling;
+  gen.set_policy(&bad_tiling);
+  bool rejected = false;
+  try {
+    gen.generate(dsc, a);
+  } catch(const char * e) {
+    rejected = true;
+  }
+  all_ok &= rejected;
+  cout << "Test result = " << all_ok << endl;
+  return all_ok;
+}
 }
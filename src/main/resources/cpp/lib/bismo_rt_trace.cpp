@@ -0,0 +1,166 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "bismo_rt_internal.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace bismo_rt {
+
+std::atomic<bool> trace_enabled(false);
+TraceBuffer * trace_buffer = 0;
+std::chrono::steady_clock::time_point trace_epoch;
+
+TraceBuffer::TraceBuffer(size_t nevents) {
+  // round up to a power of two so that slots can be found with a mask
+  size_t n = 1;
+  while(n < nevents) {
+    n <<= 1;
+  }
+  m_slots = new Slot[n];
+  m_mask = n - 1;
+  clear();
+}
+
+TraceBuffer::~TraceBuffer() {
+  delete [] m_slots;
+}
+
+void TraceBuffer::clear() {
+  for(size_t i = 0; i <= m_mask; i++) {
+    m_slots[i].seq.store(0);
+  }
+  m_head.store(0);
+}
+
+void TraceBuffer::push(const TraceEvent & e) {
+  const uint64_t idx = m_head.fetch_add(1, std::memory_order_relaxed);
+  Slot & s = m_slots[idx & m_mask];
+  // odd while being written, 2 * (idx + 1) once complete
+  s.seq.store(2 * idx + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s.e = e;
+  s.seq.store(2 * idx + 2, std::memory_order_release);
+}
+
+bool TraceBuffer::dump(const std::string & filename) {
+  std::ofstream out(filename.c_str());
+  if(!out) {
+    return false;
+  }
+  const uint64_t head = m_head.load(std::memory_order_acquire);
+  const uint64_t first = (head > m_mask + 1) ? head - (m_mask + 1) : 0;
+  // timestamps are in microseconds, keep the nanoseconds
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+  out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":";
+  out << BISMORT_TRACE_ACCEL_TID << ",\"args\":{\"name\":\"accelerator\"}}";
+  for(uint64_t idx = first; idx < head; idx++) {
+    Slot & s = m_slots[idx & m_mask];
+    const uint64_t seq = s.seq.load(std::memory_order_acquire);
+    TraceEvent e = s.e;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(seq != 2 * idx + 2 || s.seq.load(std::memory_order_relaxed) != seq) {
+      // still being written or already overwritten
+      continue;
+    }
+    out << "," << std::endl;
+    out << "{\"ph\":\"" << e.ph << "\",\"name\":\"" << e.name << "\",\"pid\":0";
+    out << ",\"tid\":" << e.tid << ",\"ts\":" << e.ts_ns / 1000.0;
+    if(e.ph == 'X') {
+      out << ",\"dur\":" << e.dur_ns / 1000.0;
+    } else if(e.arg_names) {
+      out << ",\"args\":{";
+      for(size_t i = 0; i < e.nargs; i++) {
+        out << (i ? "," : "") << "\"" << e.arg_names[i] << "\":" << e.args[i];
+      }
+      out << "}";
+    }
+    out << "}";
+  }
+  out << std::endl << "]}" << std::endl;
+  return (bool) out;
+}
+
+uint32_t trace_tid() {
+  // host threads get ids starting after the accelerator track
+  static std::atomic<uint32_t> next_tid(BISMORT_TRACE_ACCEL_TID + 1);
+  static thread_local uint32_t tid = next_tid++;
+  return tid;
+}
+
+void trace_complete(const char * name, uint64_t t0_ns, uint64_t t1_ns, uint32_t tid) {
+  TraceEvent e;
+  e.name = name;
+  e.arg_names = 0;
+  e.nargs = 0;
+  e.ph = 'X';
+  e.tid = tid;
+  e.ts_ns = t0_ns;
+  e.dur_ns = (t1_ns > t0_ns) ? t1_ns - t0_ns : 0;
+  trace_buffer->push(e);
+}
+
+void trace_counter(const char * name, const char * const * arg_names, const float * vals, size_t n) {
+  TraceEvent e;
+  e.name = name;
+  e.arg_names = arg_names;
+  e.nargs = (uint8_t) std::min(n, (size_t) 3);
+  e.ph = 'C';
+  e.tid = BISMORT_TRACE_ACCEL_TID;
+  e.ts_ns = trace_now();
+  e.dur_ns = 0;
+  for(size_t i = 0; i < 3; i++) {
+    e.args[i] = (i < n) ? vals[i] : 0;
+  }
+  trace_buffer->push(e);
+}
+
+void setTracing(bool enable) {
+  if(enable && !trace_enabled) {
+    if(!trace_buffer) {
+      trace_buffer = new TraceBuffer(BISMORT_TRACE_EVENTS);
+    }
+    trace_buffer->clear();
+    trace_epoch = std::chrono::steady_clock::now();
+  }
+  trace_enabled = enable;
+}
+
+bool dumpTrace(const std::string & filename) {
+  if(!trace_buffer) {
+    return false;
+  }
+  return trace_buffer->dump(filename);
+}
+
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BISMORT_TRACE_HPP
+#define BISMORT_TRACE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace bismo_rt {
+
+// track (thread id in the trace) used for what runs on the accelerator
+#define BISMORT_TRACE_ACCEL_TID 0
+
+// one timestamped trace event, either a complete event with a duration or
+// a sample of up to three counter values
+struct TraceEvent {
+  const char * name;                // must be a string with static lifetime
+  const char * const * arg_names;   // counter value names, 0 for none
+  uint8_t nargs;                    // number of counter values, at most 3
+  char ph;                          // Chrome trace phase, 'X' or 'C'
+  uint32_t tid;
+  uint64_t ts_ns, dur_ns;
+  float args[3];
+};
+
+// fixed-size ring buffer of trace events. writers never block or allocate,
+// they claim a slot with a single atomic increment and the oldest events
+// are overwritten once the buffer is full. each slot carries a sequence
+// number so that dump() can skip slots that are being written.
+class TraceBuffer {
+public:
+  TraceBuffer(size_t nevents);
+  ~TraceBuffer();
+  void push(const TraceEvent & e);
+  void clear();
+  // write all buffered events as Chrome trace JSON, returns false on error
+  bool dump(const std::string & filename);
+
+protected:
+  struct Slot {
+    std::atomic<uint64_t> seq;
+    TraceEvent e;
+  };
+  Slot * m_slots;
+  size_t m_mask;
+  std::atomic<uint64_t> m_head;
+};
+
+extern std::atomic<bool> trace_enabled;
+extern TraceBuffer * trace_buffer;
+extern std::chrono::steady_clock::time_point trace_epoch;
+
+inline bool tracing() {
+  return trace_enabled.load(std::memory_order_relaxed);
+}
+
+// nanoseconds since tracing was enabled
+inline uint64_t trace_time(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(t - trace_epoch).count();
+}
+
+inline uint64_t trace_now() {
+  return trace_time(std::chrono::steady_clock::now());
+}
+
+// small id of the calling thread, used as its track in the trace
+uint32_t trace_tid();
+
+// record a complete event from t0_ns to t1_ns
+void trace_complete(const char * name, uint64_t t0_ns, uint64_t t1_ns, uint32_t tid);
+// record a sample of n <= 3 counter values
+void trace_counter(const char * name, const char * const * arg_names, const float * vals, size_t n);
+
+// records a complete event for its own lifetime if tracing is enabled
+class TraceScope {
+public:
+  TraceScope(const char * name) {
+    m_name = tracing() ? name : 0;
+    if(m_name) {
+      m_start = trace_now();
+    }
+  };
+  ~TraceScope() {
+    if(m_name) {
+      trace_complete(m_name, m_start, trace_now(), trace_tid());
+    }
+  };
+protected:
+  const char * m_name;
+  uint64_t m_start;
+};
+
+}
+
+#endif /* end of include guard: BISMORT_TRACE_HPP */
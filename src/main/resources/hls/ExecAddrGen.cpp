@@ -34,7 +34,7 @@
 #include <stdint.h>
 #include "BISMOInstruction.hpp"
 
-#define BISMO_EXECADDRSTRUCT_BITS 42
+#define BISMO_EXECADDRSTRUCT_BITS 44
 
 struct ExecAddr {
   ap_uint<16> lhsAddr;
@@ -44,7 +44,7 @@ struct ExecAddr {
   ap_uint<1> negate;
   ap_uint<5> shift;
   ap_uint<1> writeEn;
-  ap_uint<1> writeAddr;
+  ap_uint<BISMO_LIMIT_RESADDR_BITS> writeAddr;
 
   ap_uint<BISMO_EXECADDRSTRUCT_BITS> asRaw() {
     ap_uint<BISMO_EXECADDRSTRUCT_BITS> ret = 0;
@@ -55,7 +55,7 @@ struct ExecAddr {
     ret(34, 34) = negate;
     ret(39, 35) = shift;
     ret(40, 40) = writeEn;
-    ret(41, 41) = writeAddr;
+    ret(43, 41) = writeAddr;
     return ret;
   }
 
@@ -67,7 +67,7 @@ struct ExecAddr {
     negate = raw(34, 34);
     shift = raw(39, 35);
     writeEn = raw(40, 40);
-    writeAddr = raw(41, 41);
+    writeAddr = raw(43, 41);
   }
 
   ExecAddr() {
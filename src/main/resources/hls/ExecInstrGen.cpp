@@ -39,7 +39,9 @@ template <
   // capacity of LHS and RHS memories (in elements)
   size_t LMEM, size_t RMEM,
   // exec-to-fetch left-shift ratio: log2(K / fetch width)
-  size_t ETF_S
+  size_t ETF_S,
+  // number of exec-result buffers
+  size_t RES
 >
 void ExecInstrGen_RHSLHSTiling(
   hls::stream<ap_uint<BISMO_MMDESCR_BITS>> & in,
@@ -71,18 +73,32 @@ io_section:{
   uint8_t z1 = slice < ins_in.bits_r ? 0 : (slice - ins_in.bits_r + 1);
   uint8_t z2 = slice < ins_in.bits_l ? 0 : (slice - ins_in.bits_l + 1);
   int8_t j = slice - z2;
-  uint8_t offset_res = 0;
+  // result buffer index continues from the previous descriptor
+  static uint8_t offset_res = 0;
   // l and r are derived from the loop indices
   uint8_t l = 0, r = 0;
   // mems are divided into regions to provide fetch-exec concurrency
+  // the current region is kept across descriptors, so that back-to-back
+  // descriptors use the regions in the same order as the other stages
   const uint8_t lmem_num_regions = (1 << ins_in.nbufs_fetch_exec_log2);
   const uint16_t lmem_region_size = (LMEM >> ins_in.nbufs_fetch_exec_log2);
-  uint8_t lmem_region = 0;
-  uint16_t lmem_region_offset = 0;
+  static uint8_t lmem_region = 0;
+  if(lmem_region >= lmem_num_regions) {
+    lmem_region = 0;
+  }
+  uint16_t lmem_region_offset = lmem_region * lmem_region_size;
   const uint8_t rmem_num_regions = (1 << ins_in.nbufs_fetch_exec_log2);
   const uint16_t rmem_region_size = (RMEM >> ins_in.nbufs_fetch_exec_log2);
-  uint8_t rmem_region = 0;
-  uint16_t rmem_region_offset = 0;
+  static uint8_t rmem_region = 0;
+  if(rmem_region >= rmem_num_regions) {
+    rmem_region = 0;
+  }
+  uint16_t rmem_region_offset = rmem_region * rmem_region_size;
+  // which operand stays in its buffer while the other one streams past it
+  const bool lhs_stationary = (ins_in.tiling == tilingLHSRHS);
+  // whether all LHS tiles are in a single region, see FetchInstrGen
+  const bool lhs_resident = (ins_in.tiling == tilingLHSResident);
+  const uint16_t lhs_tile_entries = ins_in.bits_l * ins_in.tiles_k;
   // single iteration space for the entire instrgen
   for(size_t i = 0; i < total_iters; i++) {
     #pragma HLS PIPELINE II=1
@@ -92,8 +108,15 @@ io_section:{
     // helper variables based on current loop iteration
     const bool tile_first = (slice == 0);
     const bool tile_last = (slice == (ins_in.bits_l + ins_in.bits_r - 2));
-    const bool rhstile_first = tile_first && (m == 0);
-    const bool rhstile_last = tile_last && (m == ins_in.tiles_m-1);
+    // first/last result tile that uses the current RHS/LHS tile, see
+    // FetchInstrGen for the loop orders
+    const bool rhstile_first = tile_first && (lhs_stationary || (m == 0));
+    const bool rhstile_last = tile_last && (lhs_stationary || (m == ins_in.tiles_m-1));
+    const bool lhstile_first = tile_first && (lhs_resident ?
+      (m == 0 && n == 0) : (!lhs_stationary || (n == 0)));
+    const bool lhstile_last = tile_last && (lhs_resident ?
+      (m == ins_in.tiles_m-1 && n == ins_in.tiles_n-1) :
+      (!lhs_stationary || (n == ins_in.tiles_n-1)));
     if(rhstile_first) {
       // when starting a new tile, wait for fetch stage to signal
       sync.isSendToken = 0;
@@ -101,12 +124,14 @@ io_section:{
       out.write(sync.asRaw());
       ap_wait();
     }
-    if(tile_first) {
+    if(lhstile_first) {
       // when starting a new tile, wait for fetch stage to signal
       sync.isSendToken = 0;
       sync.chanID = 0;
       out.write(sync.asRaw());
       ap_wait();
+    }
+    if(tile_first && !ins_in.defer_writeback) {
       // starting a new result tile:
       // acquire a result buffer
       sync.isRunCfg = 0;
@@ -123,23 +148,26 @@ io_section:{
     const bool neg_r = rbit_last && ins_in.signed_r;
     bool negate = neg_l ^ neg_r;
     // TODO consider removing mults here, use mod counters
-    const uint16_t offset_l = ins_in.tiles_k * l;
+    const uint16_t offset_l = (lhs_resident ? m * lhs_tile_entries : 0) + ins_in.tiles_k * l;
     const uint16_t offset_r = ins_in.tiles_k * r;
     exec.lhsOffset = (ins_in.base_l + lmem_region_offset + offset_l) << ETF_S;
     // note: no buffer regions for RHS tiles
     exec.rhsOffset = (ins_in.base_r + rmem_region_offset + offset_r) << ETF_S;
     exec.numTiles = ins_in.tiles_k;
-    exec.shiftAmount = (j == slice - z2 ? 1 : 0);
+    // when continuing from the previous descriptor's accumulators, the
+    // first slice must not shift the partial sum
+    const bool cont = tile_first && ins_in.accumulate;
+    exec.shiftAmount = (j == slice - z2 && !cont ? 1 : 0);
     exec.negate = negate ? 1 : 0;
     // clear accumulator on first iteration of this result tile
-    exec.clear_before_first_accumulation = tile_first ? 1 : 0;
+    exec.clear_before_first_accumulation = tile_first && !cont ? 1 : 0;
 
     // write result on first iteration of this result tile
-    exec.writeEn = tile_last ? 1 : 0;
+    exec.writeEn = tile_last && !ins_in.defer_writeback ? 1 : 0;
     exec.writeAddr = ins_in.base_res + offset_res;
     out.write(exec.asRaw());
     ap_wait();
-    if(tile_last) {
+    if(tile_last && !ins_in.defer_writeback) {
       // finished computing result tile
       // release the result buffer
       sync.isSendToken = 1;
@@ -148,16 +176,18 @@ io_section:{
       ap_wait();
       // iteration tracking logic: result buffer offset
       offset_res++;
-      if(offset_res == 2) {
+      if(offset_res == RES) {
         offset_res = 0;
       }
-      // when finishing with rhs tile, signal fetch stage to release buffer
+    }
+    if(lhstile_last) {
+      // when finishing with lhs tile, signal fetch stage to release buffer
       // release the input buffers
       sync.isSendToken = 1;
       sync.chanID = 0;
       out.write(sync.asRaw());
       ap_wait();
-      // use the next rmem region for following fetch
+      // use the next lmem region for following fetch
       lmem_region++;
       lmem_region_offset += lmem_region_size;
       if(lmem_region == lmem_num_regions) {
@@ -192,12 +222,23 @@ io_section:{
         z1 = slice < ins_in.bits_r ? 0 : slice - ins_in.bits_r + 1;
         z2 = slice < ins_in.bits_l ? 0 : slice - ins_in.bits_l + 1;
         j = slice - z2;
-        m++;
-        if(m == ins_in.tiles_m) {
-          m = 0;
+        if(lhs_stationary) {
           n++;
           if(n == ins_in.tiles_n) {
             n = 0;
+            m++;
+            if(m == ins_in.tiles_m) {
+              m = 0;
+            }
+          }
+        } else {
+          m++;
+          if(m == ins_in.tiles_m) {
+            m = 0;
+            n++;
+            if(n == ins_in.tiles_n) {
+              n = 0;
+            }
           }
         }
       }
@@ -216,6 +257,7 @@ void ExecInstrGen(
   #pragma HLS INTERFACE axis port=in
 
   ExecInstrGen_RHSLHSTiling<
-    TEMPLATE_PARAM_LMEM, TEMPLATE_PARAM_RMEM, TEMPLATE_PARAM_ETF_S
+    TEMPLATE_PARAM_LMEM, TEMPLATE_PARAM_RMEM, TEMPLATE_PARAM_ETF_S,
+    TEMPLATE_PARAM_RES
   >(in, out);
 }
@@ -67,15 +67,23 @@ io_section:{
   ap_wait();
 
   // mems are divided into regions to provide fetch-exec concurrency
+  // the current region is kept across descriptors, so that back-to-back
+  // descriptors use the regions in the same order as the other stages
   const uint8_t lmem_num_regions = (1 << ins_in.nbufs_fetch_exec_log2);
   const uint16_t lmem_region_size = (LMEM >> ins_in.nbufs_fetch_exec_log2);
-  uint8_t lmem_region = 0;
-  uint16_t lmem_region_offset = 0;
+  static uint8_t lmem_region = 0;
+  if(lmem_region >= lmem_num_regions) {
+    lmem_region = 0;
+  }
+  uint16_t lmem_region_offset = lmem_region * lmem_region_size;
 
   const uint8_t rmem_num_regions = (1 << ins_in.nbufs_fetch_exec_log2);
   const uint16_t rmem_region_size = (RMEM >> ins_in.nbufs_fetch_exec_log2);
-  uint8_t rmem_region = 0;
-  uint16_t rmem_region_offset = 0;
+  static uint8_t rmem_region = 0;
+  if(rmem_region >= rmem_num_regions) {
+    rmem_region = 0;
+  }
+  uint16_t rmem_region_offset = rmem_region * rmem_region_size;
 
   const int first_lhs_id = 0;
   const int first_rhs_id = M;
@@ -86,8 +94,20 @@ io_section:{
   const size_t total_iters = ins_in.tiles_m * ins_in.tiles_n;
   uint16_t n = 0, m = 0;
 
+  // which operand stays in its buffer while the other one streams past it
+  const bool lhs_stationary = (ins_in.tiling == tilingLHSRHS);
+  // whether all LHS tiles are fetched once into a single region, one after
+  // the other, and stay there for the entire descriptor
+  const bool lhs_resident = (ins_in.tiling == tilingLHSResident);
+  const uint16_t lhs_tile_entries = ins_in.bits_l * ins_in.tiles_k;
+  const uint16_t lhs_tiles_per_fetch = lhs_resident ? ins_in.tiles_m : 1;
+
   for(uint16_t i = 0; i < total_iters; i++) {
-    if(m == 0) {
+    // a new RHS tile for each LHS tile if LHS-stationary, only when starting
+    // a new column of tiles otherwise. and vice versa for LHS tiles.
+    const bool new_rhs = lhs_stationary || (m == 0);
+    const bool new_lhs = lhs_resident ? (i == 0) : (!lhs_stationary || (n == 0));
+    if(new_rhs) {
       // receive token from execute stage representing RHS buf
       sync.isSendToken = 0;
       sync.chanID = 0;
@@ -129,53 +149,70 @@ io_section:{
         rmem_region_offset = 0;
       }
     }
-    // receive token from execute stage representing LHS buf
-    sync.isSendToken = 0;
-    sync.chanID = 0;
-    out.write(sync.asRaw());
-    ap_wait();
-    // fill LHS buffer
-    // each bit position is one block
-    fetch.dram_block_count = ins_in.bits_l;
-    // each block is a group of Dm rows' worth of bits
-    fetch.dram_block_size_bytes = ins_in.tiles_k * bytes_per_lhs_tile;
-    // block stride/skip is one bit position worth of bits
-    fetch.dram_block_offset_bytes = ins_in.tiles_m * ins_in.tiles_k * bytes_per_lhs_tile;
-    // IMPORTANT TODO: put in SW assertions around sizes of these, especially
-    // dram_block_offset_bytes! other option is to generate one
-    // fetch instruction per bit position...
-    // DRAM base address for LHS
-    fetch.dram_base = ins_in.dram_lhs + m * ins_in.tiles_k * bytes_per_lhs_tile;
-    fetch.bram_addr_base = (ins_in.base_l + lmem_region_offset) << ETF_S;
-    fetch.bram_id_start = first_lhs_id;
-    // ID range of BRAM: 0 for LHS, 1 for RHS
-    fetch.bram_id_range = 0;
-    // how many DRAM data words are copied before the
-    // fetch interconnect starts targeting the next BRAM
-    fetch.tiles_per_row = ins_in.tiles_k << ETF_S;
-    // emit fetch instruction for RHS matrix
-    out.write(fetch.asRaw());
-    ap_wait();
-    // signal that LHS buffer now filled
-    // send token to execute stage
-    sync.isSendToken = 1;
-    sync.chanID = 0;
-    out.write(sync.asRaw());
+    if(new_lhs) {
+      // receive token from execute stage representing LHS buf
+      sync.isSendToken = 0;
+      sync.chanID = 0;
+      out.write(sync.asRaw());
+      ap_wait();
+      // fill LHS buffer
+      // each bit position is one block
+      fetch.dram_block_count = ins_in.bits_l;
+      // each block is a group of Dm rows' worth of bits
+      fetch.dram_block_size_bytes = ins_in.tiles_k * bytes_per_lhs_tile;
+      // block stride/skip is one bit position worth of bits
+      fetch.dram_block_offset_bytes = ins_in.tiles_m * ins_in.tiles_k * bytes_per_lhs_tile;
+      // IMPORTANT TODO: put in SW assertions around sizes of these, especially
+      // dram_block_offset_bytes! other option is to generate one
+      // fetch instruction per bit position...
+      fetch.bram_id_start = first_lhs_id;
+      // ID range of BRAM: 0 for LHS, 1 for RHS
+      fetch.bram_id_range = 0;
+      // how many DRAM data words are copied before the
+      // fetch interconnect starts targeting the next BRAM
+      fetch.tiles_per_row = ins_in.tiles_k << ETF_S;
+      for(uint16_t t = 0; t < lhs_tiles_per_fetch; t++) {
+        // DRAM base address for LHS
+        const uint16_t lhs_tile = lhs_resident ? t : m;
+        fetch.dram_base = ins_in.dram_lhs + lhs_tile * ins_in.tiles_k * bytes_per_lhs_tile;
+        fetch.bram_addr_base = (ins_in.base_l + lmem_region_offset + t * lhs_tile_entries) << ETF_S;
+        // emit fetch instruction for LHS matrix
+        out.write(fetch.asRaw());
+        ap_wait();
+      }
+      // signal that LHS buffer now filled
+      // send token to execute stage
+      sync.isSendToken = 1;
+      sync.chanID = 0;
+      out.write(sync.asRaw());
 
-    // use the next lmem region for following fetch
-    lmem_region++;
-    lmem_region_offset += lmem_region_size;
-    if(lmem_region == lmem_num_regions) {
-      lmem_region = 0;
-      lmem_region_offset = 0;
+      // use the next lmem region for following fetch
+      lmem_region++;
+      lmem_region_offset += lmem_region_size;
+      if(lmem_region == lmem_num_regions) {
+        lmem_region = 0;
+        lmem_region_offset = 0;
+      }
     }
-    // iteration tracking logic: nested loops over tiles
-    m++;
-    if(m == ins_in.tiles_m) {
-      m = 0;
+    // iteration tracking logic: nested loops over tiles, with the
+    // stationary operand in the outer loop
+    if(lhs_stationary) {
       n++;
       if(n == ins_in.tiles_n) {
         n = 0;
+        m++;
+        if(m == ins_in.tiles_m) {
+          m = 0;
+        }
+      }
+    } else {
+      m++;
+      if(m == ins_in.tiles_m) {
+        m = 0;
+        n++;
+        if(n == ins_in.tiles_n) {
+          n = 0;
+        }
       }
     }
   }
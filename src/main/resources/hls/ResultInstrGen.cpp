@@ -39,7 +39,9 @@ template <
   // matmul array dimensions: rows, cols (note: no common)
   size_t M, size_t N,
   // bits per accumulator
-  size_t A
+  size_t A,
+  // number of exec-result buffers
+  size_t RES
 >
 void ResultInstrGen_RHSTiling_Templated(
   hls::stream<ap_uint<BISMO_MMDESCR_BITS>> & in,
@@ -68,12 +70,16 @@ io_section:{
   ap_wait();
 
   // compute the size of the iteration space
-  const size_t total_iters = ins_in.tiles_m * ins_in.tiles_n;
+  // nothing to write if the results stay in the exec stage accumulators
+  const size_t total_iters = ins_in.defer_writeback ? 0 : ins_in.tiles_m * ins_in.tiles_n;
   /// iteration variables
   uint16_t m = 0, n = 0;
-  uint8_t offset_res = 0;
+  // result buffer index continues from the previous descriptor
+  static uint8_t offset_res = 0;
   const size_t lhs_nrows_a = ins_in.tiles_m * M;
   const size_t dram_skip = bytes_per_acc * lhs_nrows_a;
+  // same tile order as the exec stage, see ExecInstrGen
+  const bool lhs_stationary = (ins_in.tiling == tilingLHSRHS);
   // single iteration space for the entire instrgen
   for(size_t i = 0; i < total_iters; i++) {
     // start by acquiring buffer from execute stage
@@ -97,8 +103,7 @@ io_section:{
     ap_wait();
     // update the result buffer offset
     offset_res++;
-    // TODO: pass #exec-res buffers as template parameter as well
-    if(offset_res == 2) {
+    if(offset_res == RES) {
       offset_res = 0;
     }
     // signal that res buffer is now free to be recycled
@@ -108,12 +113,23 @@ io_section:{
     out.write(sync.asRaw());
     ap_wait();
     // iteration tracking logic: nested loops over tiles
-    m++;
-    if(m == ins_in.tiles_m) {
-      m = 0;
+    if(lhs_stationary) {
       n++;
       if(n == ins_in.tiles_n) {
         n = 0;
+        m++;
+        if(m == ins_in.tiles_m) {
+          m = 0;
+        }
+      }
+    } else {
+      m++;
+      if(m == ins_in.tiles_m) {
+        m = 0;
+        n++;
+        if(n == ins_in.tiles_n) {
+          n = 0;
+        }
       }
     }
   }
@@ -137,7 +153,8 @@ void ResultInstrGen(
   #pragma HLS INTERFACE axis port=in
 
   ResultInstrGen_RHSTiling_Templated<
-    TEMPLATE_PARAM_M, TEMPLATE_PARAM_N, TEMPLATE_PARAM_A
+    TEMPLATE_PARAM_M, TEMPLATE_PARAM_N, TEMPLATE_PARAM_A,
+    TEMPLATE_PARAM_RES
   >(
     in, out
   );
@@ -32,3 +32,4 @@
 #define TEMPLATE_PARAM_LMEM   1024
 #define TEMPLATE_PARAM_RMEM   1024
 #define TEMPLATE_PARAM_ETF_S  0
+#define TEMPLATE_PARAM_RES    2
@@ -715,6 +715,9 @@ bool TestExecInstrGen() {
   desc.base_l = 0;
   desc.base_r = 0;
   desc.nbufs_fetch_exec_log2 = 2;
+  desc.tiling = tilingRHSLHS;
+  desc.accumulate = false;
+  desc.defer_writeback = false;
   desc.dram_lhs = 0;
   desc.dram_rhs = 1000;
   in.write(desc.asRaw());
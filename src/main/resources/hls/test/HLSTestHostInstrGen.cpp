@@ -0,0 +1,179 @@
+// Copyright (c) 2019 Xilinx
+//
+// BSD v3 License
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of BISMO nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ap_int.h>
+#include <hls_stream.h>
+#include "BISMOInstruction.hpp"
+#include "bismo_rt_instrgen.hpp"
+#include "HostInstrGen_TemplateDefs.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// checks that the host-side instruction generator of the runtime produces
+// exactly the same instructions as the HLS instruction generators for the
+// same sequence of descriptors
+
+void FetchInstrGen(
+  hls::stream<ap_uint<BISMO_MMDESCR_BITS>> & in,
+  hls::stream<ap_uint<BISMO_INSTR_BITS>> & out
+);
+
+void ExecInstrGen(
+  hls::stream<ap_uint<BISMO_MMDESCR_BITS>> & in,
+  hls::stream<ap_uint<BISMO_INSTR_BITS>> & out
+);
+
+void ResultInstrGen(
+  hls::stream<ap_uint<BISMO_MMDESCR_BITS>> & in,
+  hls::stream<ap_uint<BISMO_INSTR_BITS>> & out
+);
+
+typedef void (*HLSInstrGen)(
+  hls::stream<ap_uint<BISMO_MMDESCR_BITS>> & in,
+  hls::stream<ap_uint<BISMO_INSTR_BITS>> & out
+);
+
+bool compare_stream(
+  HLSInstrGen gen, const char * name, SingleMMDescriptor & desc,
+  const std::vector<BISMOInstruction> & host
+) {
+  hls::stream<ap_uint<BISMO_MMDESCR_BITS>> in;
+  hls::stream<ap_uint<BISMO_INSTR_BITS>> out;
+  in.write(desc.asRaw());
+  gen(in, out);
+  bool all_OK = true;
+  if(out.size() != host.size()) {
+    cout << "ERROR: " << name << " produced " << out.size();
+    cout << " instructions, host produced " << host.size() << endl;
+    all_OK = false;
+  }
+  for(size_t i = 0; !out.empty(); i++) {
+    BISMOInstruction ins = out.read();
+    if(i < host.size() && ins != host[i]) {
+      cout << "ERROR: " << name << " mismatch at instruction " << i << endl;
+      cout << "HLS: " << ins << endl;
+      cout << "Host: " << host[i] << endl;
+      all_OK = false;
+    }
+  }
+  return all_OK;
+}
+
+SingleMMDescriptor make_desc(
+  uint16_t tiles_m, uint16_t tiles_k, uint16_t tiles_n, uint8_t bits_l,
+  uint8_t bits_r, uint8_t tiling, bool accumulate, bool defer_writeback
+) {
+  SingleMMDescriptor desc;
+  desc.tiles_m = tiles_m;
+  desc.tiles_k = tiles_k;
+  desc.tiles_n = tiles_n;
+  desc.bits_l = bits_l;
+  desc.bits_r = bits_r;
+  desc.signed_l = false;
+  desc.signed_r = false;
+  desc.base_l = 0;
+  desc.base_r = 0;
+  desc.base_res = 0;
+  desc.nbufs_fetch_exec_log2 = 1;
+  desc.tiling = tiling;
+  desc.accumulate = accumulate;
+  desc.defer_writeback = defer_writeback;
+  desc.dram_lhs = 0;
+  desc.dram_rhs = 1000;
+  desc.dram_res = 2000;
+  return desc;
+}
+
+bool TestHostInstrGen() {
+  cout << "Now running HLS Test for the host-side InstrGen" << endl;
+  HardwareCfg cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.dpaDimLHS = TEMPLATE_PARAM_M;
+  cfg.dpaDimCommon = TEMPLATE_PARAM_K;
+  cfg.dpaDimRHS = TEMPLATE_PARAM_N;
+  cfg.readChanWidth = TEMPLATE_PARAM_K >> TEMPLATE_PARAM_ETF_S;
+  cfg.lhsEntriesPerMem = TEMPLATE_PARAM_LMEM;
+  cfg.rhsEntriesPerMem = TEMPLATE_PARAM_RMEM;
+  cfg.accWidth = TEMPLATE_PARAM_A;
+  cfg.resEntriesPerMem = TEMPLATE_PARAM_RES;
+  bismo_rt::InstrGen igen(cfg);
+
+  // each loop order, then a K-chunked matrix multiply that accumulates in
+  // the result buffer and only writes back after the last chunk
+  std::vector<SingleMMDescriptor> descs;
+  descs.push_back(make_desc(3, 2, 4, 2, 3, tilingRHSLHS, false, false));
+  descs.push_back(make_desc(4, 3, 2, 1, 2, tilingLHSRHS, false, false));
+  descs.push_back(make_desc(5, 2, 3, 3, 1, tilingLHSResident, false, false));
+  descs.push_back(make_desc(1, 4, 1, 1, 1, tilingRHSLHS, false, true));
+  descs.push_back(make_desc(1, 4, 1, 1, 1, tilingRHSLHS, true, true));
+  descs.push_back(make_desc(1, 2, 1, 1, 1, tilingRHSLHS, true, false));
+  // followed by random descriptors, the generators carry the buffer regions
+  // and the result buffer in use across all of them
+  srand(42);
+  for(size_t i = 0; i < 200; i++) {
+    SingleMMDescriptor desc = make_desc(
+      1 + rand() % 5, 1 + rand() % 4, 1 + rand() % 5, 1 + rand() % 4,
+      1 + rand() % 4, rand() % 3, rand() % 2, rand() % 2
+    );
+    desc.signed_l = rand() % 2;
+    desc.signed_r = rand() % 2;
+    desc.base_l = rand() % 8;
+    desc.base_r = rand() % 8;
+    desc.nbufs_fetch_exec_log2 = rand() % 3;
+    desc.dram_lhs = rand();
+    desc.dram_rhs = rand();
+    desc.dram_res = rand();
+    descs.push_back(desc);
+  }
+
+  bool all_OK = true;
+  for(auto & desc : descs) {
+    bismo_rt::InstrStreams host;
+    igen.generate(desc, host);
+    all_OK &= compare_stream(FetchInstrGen, "FetchInstrGen", desc, host.fetch);
+    all_OK &= compare_stream(ExecInstrGen, "ExecInstrGen", desc, host.exec);
+    all_OK &= compare_stream(ResultInstrGen, "ResultInstrGen", desc, host.result);
+  }
+  return all_OK;
+}
+
+int main(int argc, char *argv[]) {
+  if(TestHostInstrGen()) {
+    cout << "Test passed: HostInstrGen" << endl;
+    return 0;
+  } else {
+    cout << "Test failed: HostInstrGen" << endl;
+    return -1;
+  }
+}
@@ -46,243 +46,243 @@ void make_golden(hls::stream<ap_uint<BISMO_INSTR_BITS>> & out) {
   out.write(ap_uint<BISMO_INSTR_BITS>("050000007D00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000007D88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000007D82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000007E00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000007E88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000007E82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000007F00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000007F88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000007F82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008000000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008088000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008082000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008100000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008188000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008182000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008700000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008788000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008782000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008800000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008888000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008882000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008900000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008988000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008982000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008A00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008A88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008A82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000008B00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000008B88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000008B82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009100000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009188000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009182000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009200000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009288000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009282000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009300000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009388000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009382000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009400000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009488000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009482000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009500000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009588000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009582000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009B00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009B88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009B82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009C00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009C88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009C82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009D00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009D88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009D82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009E00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009E88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009E82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("050000009F00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("050000009F88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("050000009F82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000A500000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A588000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A582000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000A600000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A688000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A682000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000A700000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A788000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A782000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000A800000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A888000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A882000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000A900000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A988000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000A982000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000AF00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000AF88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000AF82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000B000000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B088000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B082000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000B100000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B188000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B182000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000B200000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B288000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B282000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000B300000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B388000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B382000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000B900000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B988000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000B982000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000BA00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BA88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BA82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000BB00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BB88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BB82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000BC00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BC88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BC82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000BD00000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BD88000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000BD82000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000C300000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C388000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C382000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000C400000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C488000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C482000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000C500000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C588000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C582000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000C600000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C688000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C682000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("05000000C700000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("02", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C788000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("05000000C782000000000000006", 16));
   out.write(ap_uint<BISMO_INSTR_BITS>("0A", 16));
-  out.write(ap_uint<BISMO_INSTR_BITS>("010000000000004000000000000006", 16));
+  out.write(ap_uint<BISMO_INSTR_BITS>("010000000000001000000000000006", 16));
 }
 
 bool TestResultInstrGen() {
@@ -300,6 +300,9 @@ bool TestResultInstrGen() {
   desc.base_l = 0;
   desc.base_r = 0;
   desc.nbufs_fetch_exec_log2 = 2;
+  desc.tiling = tilingRHSLHS;
+  desc.accumulate = false;
+  desc.defer_writeback = false;
   desc.dram_lhs = 0;
   desc.dram_rhs = 1000;
   desc.dram_res = 2000;
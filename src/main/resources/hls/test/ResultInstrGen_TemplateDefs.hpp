@@ -32,3 +32,4 @@
 #define TEMPLATE_PARAM_M      2
 #define TEMPLATE_PARAM_N      2
 #define TEMPLATE_PARAM_A      32
+#define TEMPLATE_PARAM_RES    2
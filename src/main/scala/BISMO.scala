@@ -54,6 +54,7 @@ class BitSerialMatMulHWCfg(bitsPerField: Int) extends Bundle {
   val dpaDimCommon = UInt(width = bitsPerField)
   val lhsEntriesPerMem = UInt(width = bitsPerField)
   val rhsEntriesPerMem = UInt(width = bitsPerField)
+  val resEntriesPerMem = UInt(width = bitsPerField)
   val accWidth = UInt(width = bitsPerField)
   val maxShiftSteps = UInt(width = bitsPerField)
   val cmdQueueEntries = UInt(width = bitsPerField)
@@ -127,6 +128,7 @@ class BitSerialMatMulParams(
     ret.dpaDimCommon := UInt(dpaDimCommon)
     ret.lhsEntriesPerMem := UInt(lhsEntriesPerMem)
     ret.rhsEntriesPerMem := UInt(rhsEntriesPerMem)
+    ret.resEntriesPerMem := UInt(resEntriesPerMem)
     ret.accWidth := UInt(accWidth)
     ret.maxShiftSteps := UInt(maxShiftSteps)
     ret.cmdQueueEntries := UInt(cmdQueueEntries)
@@ -210,6 +212,8 @@ class BitSerialMatMulAccel(
     val fetch_op_count = UInt(OUTPUT, width = 32)
     val exec_op_count = UInt(OUTPUT, width = 32)
     val result_op_count = UInt(OUTPUT, width = 32)
+    // number of descriptors whose results have been fully written
+    val result_dsc_count = UInt(OUTPUT, width = 32)
     // instantiated hardware config
     val hw = new BitSerialMatMulHWCfg(32).asOutput
     // performance counter I/O
@@ -307,6 +311,7 @@ class BitSerialMatMulAccel(
     val igExec = Module(HLSBlackBox(new ExecInstrGen(new ExecInstrGenParams(
       lhsEntriesPerMem = myP.lhsEntriesPerMem,
       rhsEntriesPerMem = myP.rhsEntriesPerMem,
+      resEntriesPerMem = myP.resEntriesPerMem,
       execToFetchLeftShift = log2Ceil(myP.dpaDimCommon / myP.mrp.dataWidth)
     )))).io
     val igFetch = Module(HLSBlackBox(new FetchInstrGen(new FetchInstrGenParams(
@@ -318,7 +323,7 @@ class BitSerialMatMulAccel(
     )))).io
     val igRes = Module(HLSBlackBox(new ResultInstrGen(new ResultInstrGenParams(
       dpaDimLHS = myP.dpaDimLHS, dpaDimRHS = myP.dpaDimRHS,
-      accWidthBits = myP.accWidth
+      accWidthBits = myP.accWidth, resEntriesPerMem = myP.resEntriesPerMem
     )))).io
     // wire up reset differently (Vivado HLS BlackBox)
     igExec.rst_n := !this.reset
@@ -390,6 +395,14 @@ class BitSerialMatMulAccel(
   resultCtrl.enable := io.result_enable
   io.result_op_count := resultOpQ.count
   resultOpQ.deq <> resultCtrl.op
+  // count completed descriptors: ResultInstrGen ends each descriptor with a
+  // nop that waits for all writes to complete
+  val resultOpAsRun = new BISMOResultRunInstruction().fromBits(resultOpQ.deq.bits.toBits())
+  val regResultDscCount = Reg(init = UInt(0, width = 32))
+  when(resultOpQ.deq.fire() && resultOpAsRun.isRunCfg && resultOpAsRun.runcfg.nop && resultOpAsRun.runcfg.waitCompleteBytes > UInt(0)) {
+    regResultDscCount := regResultDscCount + UInt(1)
+  }
+  io.result_dsc_count := regResultDscCount
 
   // wire-up: fetch controller and stage
   fetchCtrl.stage_run <> fetchStage.stage_run
@@ -43,7 +43,7 @@ object BISMOLimits {
   val dramBlockCountBits = 8
   val dramBlockOffsBits = 24
   val maxShiftBits = 1
-  val resAddrBits = 1
+  val resAddrBits = 3
   val instrBits = 128
   val ifgBits = 32
   val maxBufRegions = 8
@@ -51,7 +51,7 @@ object BISMOLimits {
   val maxRepBits = 16
   val descrBits = 208
   val numStages = 3
-  val execAddrGenOutBits = 42
+  val execAddrGenOutBits = 41 + resAddrBits
   val fetchDRAMChanID = 0
   val resDRAMChanID = 0
   val p2sDRAMChanID = 1
@@ -42,7 +42,7 @@ class ExecAddrGenParams(
 )
 
 class ExecAddrGenOutput extends PrintableBundle {
-  val writeAddr = UInt(width = 1)
+  val writeAddr = UInt(width = BISMOLimits.resAddrBits)
   val writeEn = UInt(width = 1)
   val shiftAmount = UInt(width = 5)
   val negate = UInt(width = 1)
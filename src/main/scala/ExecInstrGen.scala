@@ -47,6 +47,7 @@ import fpgatidbits.hlstools.TemplatedHLSBlackBox
 class ExecInstrGenParams(
   val lhsEntriesPerMem: Int,
   val rhsEntriesPerMem: Int,
+  val resEntriesPerMem: Int,
   val execToFetchLeftShift: Int
 )
 
@@ -70,6 +71,7 @@ class ExecInstrGen(val p: ExecInstrGenParams) extends TemplatedHLSBlackBox {
   val hlsTemplateParams: Map[String, String] = Map(
     "LMEM" -> p.lhsEntriesPerMem.toString,
     "RMEM" -> p.rhsEntriesPerMem.toString,
+    "RES" -> p.resEntriesPerMem.toString,
     "ETF_S" -> p.execToFetchLeftShift.toString
   )
 }
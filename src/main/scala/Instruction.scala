@@ -96,7 +96,7 @@ class BISMOExecRunInstruction extends PrintableBundle {
 
 class BISMOResultRunInstruction extends PrintableBundle {
   val runcfg = new ResultStageCtrlIO()
-  val unused = UInt(width = 59)
+  val unused = UInt(width = 60 - BISMOLimits.resAddrBits)
   // always true
   val isRunCfg = Bool()
   // always stgResult
@@ -58,7 +58,7 @@ object Settings {
   val emuInstParams = new BitSerialMatMulParams(
     dpaDimLHS = 2, dpaDimRHS = 2, dpaDimCommon = 64, lhsEntriesPerMem = 8192,
     rhsEntriesPerMem = 1024, mrp = PYNQZ1Params.toMemReqParams(),
-    cmdQueueEntries = 4096
+    resEntriesPerMem = 4, cmdQueueEntries = 4096
   )
 
   // given accelerator or hw-sw-test name, return its hardware instantiator
@@ -96,6 +96,7 @@ object ChiselMain {
     val dpaDimRHS: Int = args(4).toInt
     val memLHS: Int = args(5).toInt
     val memRHS: Int = args(6).toInt
+    val memRes: Int = args(7).toInt
     // don't use the VHDL compressor if we are in emu mode (use model instead)
     // since we can't process VHDL in the verilator flow
     val useVhdlCompressor = (platformName != "VerilatedTester")
@@ -103,6 +104,7 @@ object ChiselMain {
       new BitSerialMatMulParams(
         dpaDimLHS = dpaDimLHS, dpaDimRHS = dpaDimRHS, dpaDimCommon = dpaDimCommon,
         lhsEntriesPerMem = memLHS, rhsEntriesPerMem = memRHS,
+        resEntriesPerMem = memRes,
         cmdQueueEntries = 512, mrp = PYNQZ1Params.toMemReqParams(),
         useVhdlCompressor = useVhdlCompressor
       )
@@ -124,10 +126,12 @@ object HLSMain {
     val dpaDimRHS: Int = args(5).toInt
     val memLHS: Int = args(6).toInt
     val memRHS: Int = args(7).toInt
+    val memRes: Int = args(8).toInt
     val accInst = Settings.makeInstFxn(
       new BitSerialMatMulParams(
         dpaDimLHS = dpaDimLHS, dpaDimRHS = dpaDimRHS, dpaDimCommon = dpaDimCommon,
         lhsEntriesPerMem = memLHS, rhsEntriesPerMem = memRHS,
+        resEntriesPerMem = memRes,
         cmdQueueEntries = 512, mrp = PYNQZ1Params.toMemReqParams()
       )
     )
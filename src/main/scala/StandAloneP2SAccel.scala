@@ -78,16 +78,20 @@ class P2SCmdIO(myP: P2SKernelParams) extends PrintableBundle {
   val actualPrecision = UInt(width = log2Up(myP.maxInBw) + 1)
   // total size of destination (bit serial) matrix in bytes
   val waitCompleteBytes = UInt(width = 32)
+  // byte offset between bit planes in the destination, 0 means packed planes
+  // (rows * row bytes). set larger to convert a group of rows of a bigger
+  // matrix into the right place of its bit-serial buffer.
+  val dstBitplaneStride = UInt(width = 32)
   // signedness (moves sign bit from maxInBw to actualPrecision)
   val signed = Bool()
 
   override def cloneType(): this.type =
     new P2SCmdIO(myP).asInstanceOf[this.type]
-  val printfStr = "DRAM {src: %x, dst: %x} matrix {rows %d, colgroups %d, bits %d} waitCompleteBytes %d signed %d\n"
+  val printfStr = "DRAM {src: %x, dst: %x} matrix {rows %d, colgroups %d, bits %d} waitCompleteBytes %d signed %d dstBitplaneStride %d\n"
   val printfElems = { () ⇒
     Seq(
       dramBaseAddrSrc, dramBaseAddrDst, matrixRows, matrixColsGroup,
-      actualPrecision, waitCompleteBytes, signed)
+      actualPrecision, waitCompleteBytes, signed, dstBitplaneStride)
   }
 }
 
@@ -214,7 +218,8 @@ class StandAloneP2SAccel(
   writeRg.in.bits.block_step := UInt(myP.dramWordBytes)
   writeRg.in.bits.block_count := regCmd.matrixColsGroup * regCmd.matrixRows
 
-  writeRg.block_intra_step := regCmd.matrixColsGroup * regCmd.matrixRows * UInt(myP.dramWordBytes)
+  val packedBitplaneStride = regCmd.matrixColsGroup * regCmd.matrixRows * UInt(myP.dramWordBytes)
+  writeRg.block_intra_step := Mux(regCmd.dstBitplaneStride === UInt(0), packedBitplaneStride, regCmd.dstBitplaneStride)
   writeRg.block_intra_count := regCmd.actualPrecision
 
   val outAddrQueue = FPGAQueue(writeRg.out, 4)
@@ -30,4 +30,4 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #!/bin/bash
 
-g++ -std=c++11 -march=native -O3 -I./hls_include -I./driver -I./test -fPIC rtlib/*.cpp driver/*.cpp -lcma -shared -o libbismo_rt.so
+g++ -std=c++11 -march=native -O3 -I./hls_include -I./driver -I./test -pthread -fPIC rtlib/*.cpp driver/*.cpp -lcma -shared -o libbismo_rt.so
@@ -29,4 +29,4 @@
 # OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #!/bin/bash
-g++ -std=c++11 -march=native -O3 -I./hls_include -I./driver -I./test -fPIC rtlib/*.cpp driver/*.cpp -lcma -shared -o libbismo_rt.so
+g++ -std=c++11 -march=native -O3 -I./hls_include -I./driver -I./test -pthread -fPIC rtlib/*.cpp driver/*.cpp -lcma -shared -o libbismo_rt.so
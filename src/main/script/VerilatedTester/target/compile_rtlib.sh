@@ -31,4 +31,4 @@
 #!/bin/bash
 VERILATOR_SRC_DIR="/usr/share/verilator/include"
 
-g++ -std=c++11 -march=native -O0 -Wno-int-to-pointer-cast -I$VERILATOR_SRC_DIR -Iverilog/verilated -I./hls_include -I./driver -I./test -fPIC rtlib/*.cpp driver/*.cpp verilog/verilated/*.cpp -shared -o libbismo_rt.so
+g++ -std=c++11 -march=native -O0 -Wno-int-to-pointer-cast -I$VERILATOR_SRC_DIR -Iverilog/verilated -I./hls_include -I./driver -I./test -pthread -fPIC rtlib/*.cpp driver/*.cpp verilog/verilated/*.cpp -shared -o libbismo_rt.so